@@ -0,0 +1,32 @@
+# 采集与分析代码：串口读取、解码、录制、稳态值与上升时间分析、触发捕获。
+# 只依赖QtCore和QtSerialPort，GUI（all.pro）和无界面程序（cli/cli.pro）共用。
+
+QT += serialport
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/channelmanager.cpp \
+    $$PWD/packetdecoder.cpp \
+    $$PWD/recording.cpp \
+    $$PWD/riseanalyzer.cpp \
+    $$PWD/sampledecoder.cpp \
+    $$PWD/serialreader.cpp \
+    $$PWD/telemetry.cpp \
+    $$PWD/trigger.cpp \
+    $$PWD/virtualdevice.cpp
+
+HEADERS += \
+    $$PWD/channelmanager.h \
+    $$PWD/packetdecoder.h \
+    $$PWD/recording.h \
+    $$PWD/ringbuffer.h \
+    $$PWD/riseanalyzer.h \
+    $$PWD/sample.h \
+    $$PWD/sampledecoder.h \
+    $$PWD/serialreader.h \
+    $$PWD/serialsettings.h \
+    $$PWD/telemetry.h \
+    $$PWD/trigger.h \
+    $$PWD/virtualdevice.h
@@ -10,11 +10,16 @@ CONFIG += c++11
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
 
+# QCustomPlot可选用OpenGL绘制（QCustomPlot::setOpenGl），需要Qt 5.4且Qt启用了OpenGL
+contains(QT_CONFIG, opengl): DEFINES += QCUSTOMPLOT_USE_OPENGL
+
 # You can also make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include(acquisition.pri)
+
 SOURCES += \
     main.cpp \
     mainwindow.cpp \
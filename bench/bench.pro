@@ -0,0 +1,32 @@
+# 解析 -> 存储 -> 绘制 全流程基准测试（QtTest QBENCHMARK）。
+#
+# 机器可读输出：
+#   ./pipelinebench -o bench.xml,xml     （或 -o bench.csv,csv / -o bench.txt,txt）
+# 无显示器时设置 QT_QPA_PLATFORM=offscreen。
+# replotShown和replotOpenGl需要显示窗口，offscreen平台下replotOpenGl通常跳过，可改用 xvfb-run。
+# replotOpenGl在没有OpenGL时跳过；没有GPU的机器可设置 LIBGL_ALWAYS_SOFTWARE=1 使用Mesa软件实现，
+# 并设置 vblank_mode=0 避免帧率被垂直同步限制。
+# 设置环境变量 BENCH_LARGE=1 时自适应采样和重绘增加1e8点的数据行（约需2 GB内存）。
+
+QT       += core gui testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = pipelinebench
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# QCustomPlot可选用OpenGL绘制（QCustomPlot::setOpenGl），需要Qt 5.4且Qt启用了OpenGL
+contains(QT_CONFIG, opengl): DEFINES += QCUSTOMPLOT_USE_OPENGL
+
+include(../acquisition.pri)
+
+SOURCES += \
+    ../qcustomplot.cpp \
+    pipelinebenchmark.cpp
+
+HEADERS += \
+    ../qcustomplot.h
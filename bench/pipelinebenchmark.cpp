@@ -0,0 +1,522 @@
+#include <QtTest>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "qcustomplot.h"
+#include "sampledecoder.h"
+#include "packetdecoder.h"
+#include "riseanalyzer.h"
+
+#define BENCH_FRAME_SIZE 1000   // 每次addData的点数，对应一帧内到达的数据
+#define BENCH_PLOT_WIDTH 1280
+#define BENCH_PLOT_HEIGHT 720
+
+namespace {
+
+/* 合成信号：一阶阶跃响应（tau = 0.2 s）叠加确定性噪声，采样率1 kHz */
+double syntheticValue(int i)
+{
+    const double t = i * 1e-3;
+    const double step = t < 1.0 ? 0.0 : 10.0 * (1.0 - std::exp(-(t - 1.0) / 0.2));
+    const double noise = 0.05 * std::sin(i * 12.9898) * std::cos(i * 78.233);
+    return 25.0 + step + noise;
+}
+
+double syntheticTime(int i)
+{
+    return i * 1e-3;
+}
+
+/* 文本帧："23.41,24.02,22.98\n" */
+QByteArray textStream(int frames, int columns)
+{
+    QByteArray data;
+    data.reserve(frames * columns * 8);
+    for (int i = 0; i < frames; ++i)
+    {
+        for (int c = 0; c < columns; ++c)
+        {
+            if (c > 0)
+                data += ',';
+            data += QByteArray::number(syntheticValue(i) + c, 'f', 2);
+        }
+        data += '\n';
+    }
+    return data;
+}
+
+/* 二进制数据包，每包columns个float32 */
+QByteArray packetStream(int packets, int columns)
+{
+    QByteArray data;
+    data.reserve(packets * (PACKET_HEADER_SIZE + 4 * columns + PACKET_CRC_SIZE));
+    for (int i = 0; i < packets; ++i)
+    {
+        QByteArray packet;
+        packet += char(PACKET_SYNC0);
+        packet += char(PACKET_SYNC1);
+        packet += char(4 * columns);
+        packet += char(0);
+        packet += char(PacketDecoder::PayloadFloat32);
+        for (int c = 0; c < columns; ++c)
+        {
+            const float value = static_cast<float>(syntheticValue(i) + c);
+            quint32 bits;
+            memcpy(&bits, &value, sizeof(bits));
+            for (int b = 0; b < 4; ++b)
+                packet += char((bits >> (8 * b)) & 0xFF);
+        }
+        const quint16 crc = PacketDecoder::crc16(reinterpret_cast<const std::uint8_t *>(packet.constData()) + 2,
+                                                 static_cast<std::size_t>(packet.size() - 2));
+        packet += char(crc & 0xFF);
+        packet += char(crc >> 8);
+        data += packet;
+    }
+    return data;
+}
+
+void fillGraph(QCPGraph *graph, int points)
+{
+    QCPDataVector *dataVector = graph->dataVector();
+    dataVector->reserve(points);
+    for (int i = 0; i < points; ++i)
+        dataVector->add(syntheticTime(i), syntheticValue(i));
+}
+
+/* 公开QCPGraph受保护的getPreparedData和getLinePlotData，单独测量自适应采样和坐标变换 */
+class BenchGraph : public QCPGraph
+{
+public:
+    BenchGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) : QCPGraph(keyAxis, valueAxis) {}
+
+    void prepare(QVector<QCPData> *lineData) const { getPreparedData(lineData, 0); }
+    void linePixels(QVector<QPointF> *linePixelData) const { getLinePlotData(linePixelData, 0); }
+};
+
+void addPointRows(bool large)
+{
+    QTest::addColumn<int>("points");
+    QTest::newRow("1e4") << 10000;
+    QTest::newRow("1e5") << 100000;
+    QTest::newRow("1e6") << 1000000;
+    QTest::newRow("1e7") << 10000000;
+    if (large)
+        QTest::newRow("1e8") << 100000000;
+}
+
+bool largeRowsEnabled()
+{
+    return qEnvironmentVariableIsSet("BENCH_LARGE");
+}
+
+/* 逐点比较的分箱循环（改为SIMD之前的实现），作为binning的对照 */
+int scalarReduce(const double *values, int count, double &minValue, double &maxValue, double &sum)
+{
+    double lowest = std::numeric_limits<double>::max();
+    double highest = -std::numeric_limits<double>::max();
+    int valid = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        const double v = values[i];
+        if (qIsNaN(v))
+            continue;
+        if (v < lowest)
+            lowest = v;
+        if (v > highest)
+            highest = v;
+        sum += v;
+        ++valid;
+    }
+    if (valid > 0)
+    {
+        minValue = lowest;
+        maxValue = highest;
+    }
+    return valid;
+}
+
+} // namespace
+
+/**
+ * @brief 解析、存储、自适应采样、重绘和上升时间分析各环节的基准测试。
+ */
+class PipelineBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void decodeText_data();
+    void decodeText();
+    void decodePackets_data();
+    void decodePackets();
+    void insert_data();
+    void insert();
+    void adaptiveSampling_data();
+    void adaptiveSampling();
+    void binning_data();
+    void binning();
+    void pixelTransform_data();
+    void pixelTransform();
+    void hitTest_data();
+    void hitTest();
+    void replot_data();
+    void replot();
+    void replotShown_data();
+    void replotShown();
+    void replotOpenGl_data();
+    void replotOpenGl();
+    void riseAnalysis_data();
+    void riseAnalysis();
+};
+
+void PipelineBenchmark::decodeText_data()
+{
+    QTest::addColumn<int>("columns");
+    QTest::newRow("1 column") << 1;
+    QTest::newRow("8 columns") << 8;
+}
+
+/**
+ * @brief 文本解码吞吐量：每次迭代解码100000帧。
+ */
+void PipelineBenchmark::decodeText()
+{
+    QFETCH(int, columns);
+    const QByteArray data = textStream(100000, columns);
+    SampleDecoder decoder;
+    std::vector<Sample> out;
+    out.reserve(100000 * columns);
+
+    QBENCHMARK {
+        decoder.reset();
+        out.clear();
+        decoder.feed(data.constData(), static_cast<std::size_t>(data.size()), out);
+    }
+    QCOMPARE(out.size(), std::size_t(100000 * columns));
+    QCOMPARE(decoder.parseErrors(), std::uint64_t(0));
+}
+
+void PipelineBenchmark::decodePackets_data()
+{
+    decodeText_data();
+}
+
+/**
+ * @brief 二进制数据包解码吞吐量：每次迭代解码100000包。
+ */
+void PipelineBenchmark::decodePackets()
+{
+    QFETCH(int, columns);
+    const QByteArray data = packetStream(100000, columns);
+    PacketDecoder decoder;
+    std::vector<Sample> out;
+    out.reserve(100000 * columns);
+
+    QBENCHMARK {
+        decoder.reset();
+        out.clear();
+        decoder.feed(data.constData(), static_cast<std::size_t>(data.size()), out);
+    }
+    QCOMPARE(out.size(), std::size_t(100000 * columns));
+    QCOMPARE(decoder.crcErrors(), std::uint64_t(0));
+}
+
+void PipelineBenchmark::insert_data()
+{
+    QTest::addColumn<int>("backend");
+    QTest::addColumn<int>("points");
+    QTest::newRow("map 1e5") << int(QCPGraph::dbMap) << 100000;
+    QTest::newRow("map 1e6") << int(QCPGraph::dbMap) << 1000000;
+    QTest::newRow("vector 1e5") << int(QCPGraph::dbVector) << 100000;
+    QTest::newRow("vector 1e6") << int(QCPGraph::dbVector) << 1000000;
+}
+
+/**
+ * @brief 数据插入速率：按帧调用addData(QVector, QVector)，与MainWindow::readData相同。
+ */
+void PipelineBenchmark::insert()
+{
+    QFETCH(int, backend);
+    QFETCH(int, points);
+
+    QVector<double> keys(BENCH_FRAME_SIZE), values(BENCH_FRAME_SIZE);
+    QCustomPlot plot;
+    QBENCHMARK {
+        plot.clearGraphs();
+        QCPGraph *graph = plot.addGraph();
+        graph->setDataBackend(static_cast<QCPGraph::DataBackend>(backend));
+        for (int begin = 0; begin < points; begin += BENCH_FRAME_SIZE)
+        {
+            for (int i = 0; i < BENCH_FRAME_SIZE; ++i)
+            {
+                keys[i] = syntheticTime(begin + i);
+                values[i] = syntheticValue(begin + i);
+            }
+            graph->addData(keys, values);
+        }
+    }
+    QCOMPARE(plot.graph(0)->dataCount(), points);
+}
+
+void PipelineBenchmark::adaptiveSampling_data()
+{
+    addPointRows(largeRowsEnabled());
+}
+
+/**
+ * @brief 自适应采样开销：全部数据可见时getPreparedData的耗时。
+ */
+void PipelineBenchmark::adaptiveSampling()
+{
+    QFETCH(int, points);
+
+    QCustomPlot plot;
+    plot.resize(BENCH_PLOT_WIDTH, BENCH_PLOT_HEIGHT);
+    BenchGraph *graph = new BenchGraph(plot.xAxis, plot.yAxis);
+    plot.addPlottable(graph);
+    graph->setDataBackend(QCPGraph::dbVector);
+    graph->setAdaptiveSampling(true);
+    fillGraph(graph, points);
+    plot.xAxis->setRange(0, syntheticTime(points));
+    plot.yAxis->setRange(20, 40);
+    plot.replot();  // 完成布局，确定坐标轴像素范围
+
+    QVector<QCPData> lineData;
+    QBENCHMARK {
+        graph->prepare(&lineData);
+    }
+    QVERIFY(!lineData.isEmpty());
+}
+
+void PipelineBenchmark::binning_data()
+{
+    QTest::addColumn<bool>("simd");
+    QTest::addColumn<int>("points");
+    QTest::newRow("scalar 1e6") << false << 1000000;
+    QTest::newRow("simd 1e6") << true << 1000000;
+    QTest::newRow("scalar 1e7") << false << 10000000;
+    QTest::newRow("simd 1e7") << true << 10000000;
+    if (largeRowsEnabled())
+    {
+        QTest::newRow("scalar 1e8") << false << 100000000;
+        QTest::newRow("simd 1e8") << true << 100000000;
+    }
+}
+
+/**
+ * @brief 按像素列求最小/最大值：把全部点分到BENCH_PLOT_WIDTH列，对比逐点循环与QCPDataVector::reduceValues。
+ */
+void PipelineBenchmark::binning()
+{
+    QFETCH(bool, simd);
+    QFETCH(int, points);
+
+    std::vector<double> values(points);
+    for (int i = 0; i < points; ++i)
+        values[i] = syntheticValue(i);
+
+    std::vector<double> minValues(BENCH_PLOT_WIDTH), maxValues(BENCH_PLOT_WIDTH);
+    QBENCHMARK {
+        for (int column = 0; column < BENCH_PLOT_WIDTH; ++column)
+        {
+            const int begin = static_cast<int>(qint64(points) * column / BENCH_PLOT_WIDTH);
+            const int end = static_cast<int>(qint64(points) * (column + 1) / BENCH_PLOT_WIDTH);
+            double sum = 0;
+            if (simd)
+                QCPDataVector::reduceValues(values.data() + begin, end - begin, minValues[column], maxValues[column], sum);
+            else
+                scalarReduce(values.data() + begin, end - begin, minValues[column], maxValues[column], sum);
+        }
+    }
+    QVERIFY(minValues.front() <= maxValues.front());
+}
+
+void PipelineBenchmark::pixelTransform_data()
+{
+    QTest::addColumn<int>("points");
+    QTest::newRow("1e5") << 100000;
+    QTest::newRow("1e6") << 1000000;
+}
+
+/**
+ * @brief 坐标变换开销：关闭自适应采样，getLinePlotData把全部可见点变换为像素坐标。
+ */
+void PipelineBenchmark::pixelTransform()
+{
+    QFETCH(int, points);
+
+    QCustomPlot plot;
+    plot.resize(BENCH_PLOT_WIDTH, BENCH_PLOT_HEIGHT);
+    BenchGraph *graph = new BenchGraph(plot.xAxis, plot.yAxis);
+    plot.addPlottable(graph);
+    graph->setDataBackend(QCPGraph::dbVector);
+    graph->setAdaptiveSampling(false);
+    fillGraph(graph, points);
+    plot.xAxis->setRange(0, syntheticTime(points));
+    plot.yAxis->setRange(20, 40);
+    plot.replot();  // 完成布局，确定坐标轴像素范围
+
+    QVector<QPointF> linePixelData;
+    QBENCHMARK {
+        graph->linePixels(&linePixelData);
+    }
+    QCOMPARE(linePixelData.size(), points);
+}
+
+void PipelineBenchmark::hitTest_data()
+{
+    pixelTransform_data();
+}
+
+/**
+ * @brief 鼠标点击的命中测试：两次重绘之间反复调用selectTest()，首次调用后使用缓存的像素列索引。
+ */
+void PipelineBenchmark::hitTest()
+{
+    QFETCH(int, points);
+
+    QCustomPlot plot;
+    plot.resize(BENCH_PLOT_WIDTH, BENCH_PLOT_HEIGHT);
+    QCPGraph *graph = plot.addGraph();
+    graph->setDataBackend(QCPGraph::dbVector);
+    graph->setAdaptiveSampling(false);
+    fillGraph(graph, points);
+    plot.xAxis->setRange(0, syntheticTime(points));
+    plot.yAxis->setRange(20, 40);
+    plot.replot();
+
+    const QRect rect = plot.axisRect()->rect();
+    const QPointF pos(rect.center().x(), plot.yAxis->coordToPixel(syntheticValue(points / 2)));
+    double distance = -1;
+    QBENCHMARK {
+        distance = graph->selectTest(pos, false);
+    }
+    QVERIFY(distance >= 0);
+}
+
+void PipelineBenchmark::replot_data()
+{
+    addPointRows(largeRowsEnabled());
+}
+
+/**
+ * @brief 离屏重绘延迟：窗口不显示，replot()绘制到QCustomPlot自己的缓冲区。
+ */
+void PipelineBenchmark::replot()
+{
+    QFETCH(int, points);
+
+    QCustomPlot plot;
+    plot.resize(BENCH_PLOT_WIDTH, BENCH_PLOT_HEIGHT);
+    QCPGraph *graph = plot.addGraph();
+    graph->setDataBackend(QCPGraph::dbVector);
+    graph->setAntialiased(true);
+    graph->setAdaptiveSampling(true);
+    fillGraph(graph, points);
+    plot.xAxis->setRange(0, syntheticTime(points));
+    plot.yAxis->setRange(20, 40);
+    plot.replot();
+
+    QBENCHMARK {
+        plot.replot();
+    }
+}
+
+void PipelineBenchmark::replotShown_data()
+{
+    addPointRows(largeRowsEnabled());
+}
+
+/**
+ * @brief 显示窗口时的重绘延迟：replot(rpImmediate)绘制到缓冲区并立即刷新窗口，作为replotOpenGl的对照。
+ */
+void PipelineBenchmark::replotShown()
+{
+    QFETCH(int, points);
+
+    QCustomPlot plot;
+    plot.resize(BENCH_PLOT_WIDTH, BENCH_PLOT_HEIGHT);
+    QCPGraph *graph = plot.addGraph();
+    graph->setDataBackend(QCPGraph::dbVector);
+    graph->setAntialiased(true);
+    graph->setAdaptiveSampling(true);
+    fillGraph(graph, points);
+    plot.xAxis->setRange(0, syntheticTime(points));
+    plot.yAxis->setRange(20, 40);
+    plot.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&plot));
+    plot.replot();
+
+    QBENCHMARK {
+        plot.replot(QCustomPlot::rpImmediate);
+    }
+}
+
+void PipelineBenchmark::replotOpenGl_data()
+{
+    addPointRows(largeRowsEnabled());
+}
+
+/**
+ * @brief 与replotShown相同，但由OpenGL视图直接绘制到窗口的帧缓冲，不读回内存。没有可用的OpenGL时跳过。
+ */
+void PipelineBenchmark::replotOpenGl()
+{
+    QFETCH(int, points);
+
+    QCustomPlot plot;
+    plot.resize(BENCH_PLOT_WIDTH, BENCH_PLOT_HEIGHT);
+    if (!plot.setOpenGl(true))
+        QSKIP("OpenGL is not available");
+    QCPGraph *graph = plot.addGraph();
+    graph->setDataBackend(QCPGraph::dbVector);
+    graph->setAntialiased(true);
+    graph->setAdaptiveSampling(true);
+    fillGraph(graph, points);
+    plot.xAxis->setRange(0, syntheticTime(points));
+    plot.yAxis->setRange(20, 40);
+    plot.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&plot));
+    plot.replot();
+    QVERIFY(plot.openGl());
+
+    QBENCHMARK {
+        plot.replot(QCustomPlot::rpImmediate);
+    }
+}
+
+void PipelineBenchmark::riseAnalysis_data()
+{
+    QTest::addColumn<int>("points");
+    QTest::newRow("1e5") << 100000;
+    QTest::newRow("1e6") << 1000000;
+}
+
+/**
+ * @brief 稳态值与上升时间分析：逐点addSample的总耗时。
+ */
+void PipelineBenchmark::riseAnalysis()
+{
+    QFETCH(int, points);
+
+    std::vector<double> times(points), values(points);
+    for (int i = 0; i < points; ++i)
+    {
+        times[i] = syntheticTime(i);
+        values[i] = syntheticValue(i);
+    }
+
+    RiseAnalyzer analyzer;
+    QBENCHMARK {
+        analyzer.reset();
+        for (int i = 0; i < points; ++i)
+            analyzer.addSample(times[i], values[i]);
+    }
+    QVERIFY(analyzer.riseDetected());
+}
+
+QTEST_MAIN(PipelineBenchmark)
+
+#include "pipelinebenchmark.moc"
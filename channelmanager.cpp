@@ -0,0 +1,139 @@
+#include "channelmanager.h"
+
+/**
+ * @brief 构造函数。
+ * @param parent 父对象指针。
+ */
+ChannelManager::ChannelManager(QObject *parent)
+    : QObject(parent)
+{
+}
+
+/**
+ * @brief 析构函数，关闭所有串口并停止工作线程。
+ */
+ChannelManager::~ChannelManager()
+{
+    release();
+    for (const auto &thread : m_threads) {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+/**
+ * @brief 打开配置中的全部串口，每个串口一个通道。
+ *
+ * 串口在各自的工作线程中打开，此处不等待。
+ * @param p 串口配置，portNames中的串口共用同一组串口参数。
+ */
+void ChannelManager::open(const SerialSettings &p)
+{
+    release();
+
+    const QStringList names = p.portNames.isEmpty() ? QStringList(p.name) : p.portNames;
+    const int threadCount = qBound(1, QThread::idealThreadCount(), names.size());
+    while (static_cast<int>(m_threads.size()) < threadCount) {
+        m_threads.emplace_back(new QThread);
+        m_threads.back()->start();
+    }
+
+    m_channels.reserve(names.size());
+    for (int i = 0; i < names.size(); ++i) {
+        Channel channel;
+        channel.name = names.at(i);
+        channel.buffer.reset(new SpscRingBuffer<Sample>(SAMPLE_BUFFER_SIZE));
+        channel.record.reset(new SpscRingBuffer<Sample>(RECORD_BUFFER_SIZE));
+        channel.reader = new SerialReader(channel.buffer.get(), i);
+        channel.reader->moveToThread(m_threads[i % threadCount].get());
+        const QString name = channel.name;
+        connect(channel.reader, &SerialReader::errorOccurred, this, [this, name](const QString &message) {
+            emit errorOccurred(name + ": " + message);
+        });
+
+        SerialReader *reader = channel.reader;
+        SerialSettings portSettings = p;
+        portSettings.name = channel.name;
+        QMetaObject::invokeMethod(reader, [reader, portSettings]() { reader->open(portSettings); }, Qt::QueuedConnection);
+
+        m_channels.push_back(std::move(channel));
+    }
+}
+
+/**
+ * @brief 关闭全部串口，等待各工作线程完成关闭。
+ *
+ * 缓冲区保留，GUI线程仍可取出剩余数据。
+ */
+void ChannelManager::close()
+{
+    for (const Channel &channel : m_channels)
+        QMetaObject::invokeMethod(channel.reader, &SerialReader::close, Qt::BlockingQueuedConnection);
+}
+
+/**
+ * @brief 关闭串口并释放所有通道。
+ *
+ * 串口关闭后读取类不会再访问缓冲区，读取类由所在线程延迟删除，缓冲区随即释放。
+ */
+void ChannelManager::release()
+{
+    close();
+    for (Channel &channel : m_channels)
+        channel.reader->deleteLater();
+    m_channels.clear();
+}
+
+/**
+ * @brief 获取各串口的录制缓冲区。
+ */
+QVector<SpscRingBuffer<Sample> *> ChannelManager::recordBuffers() const
+{
+    QVector<SpscRingBuffer<Sample> *> buffers;
+    buffers.reserve(count());
+    for (const Channel &channel : m_channels)
+        buffers.append(channel.record.get());
+    return buffers;
+}
+
+/**
+ * @brief 开始或停止向录制缓冲区写入。
+ * @param enabled true开始写入，false停止写入。
+ */
+void ChannelManager::setRecording(bool enabled)
+{
+    for (const Channel &channel : m_channels)
+        channel.reader->setRecordBuffer(enabled ? channel.record.get() : nullptr);
+}
+
+quint64 ChannelManager::droppedSamples() const
+{
+    quint64 n = 0;
+    for (const Channel &channel : m_channels)
+        n += channel.reader->droppedSamples();
+    return n;
+}
+
+quint64 ChannelManager::recordDroppedSamples() const
+{
+    quint64 n = 0;
+    for (const Channel &channel : m_channels)
+        n += channel.reader->recordDroppedSamples();
+    return n;
+}
+
+quint64 ChannelManager::parseErrors() const
+{
+    quint64 n = 0;
+    for (const Channel &channel : m_channels)
+        n += channel.reader->parseErrors();
+    return n;
+}
+
+quint64 ChannelManager::crcErrors() const
+{
+    quint64 n = 0;
+    for (const Channel &channel : m_channels)
+        n += channel.reader->crcErrors();
+    return n;
+}
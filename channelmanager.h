@@ -0,0 +1,68 @@
+#ifndef CHANNELMANAGER_H
+#define CHANNELMANAGER_H
+
+#include <QObject>
+#include <QThread>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+#include "serialsettings.h"
+#include "serialreader.h"
+#include "ringbuffer.h"
+#include "sample.h"
+
+#define SAMPLE_BUFFER_SIZE 65536    // 每个串口的采样环形缓冲区容量
+#define RECORD_BUFFER_SIZE 262144   // 每个串口的录制环形缓冲区容量
+
+/**
+ * @brief 多串口采集管理类。
+ *
+ * 每个串口对应一个SerialReader和一对独立的环形缓冲区（绘图、录制），
+ * 读取类平均分配到若干工作线程上（线程数不超过CPU核数），
+ * 解码和打时间戳都在工作线程完成，GUI线程只负责取数据和绘图。
+ */
+class ChannelManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ChannelManager(QObject *parent = nullptr);
+    ~ChannelManager();
+
+    void open(const SerialSettings &p);             // 按配置打开全部串口
+    void close();                                   // 关闭全部串口，返回后缓冲区不再有新数据
+
+    int count() const { return static_cast<int>(m_channels.size()); }
+    QString portName(int i) const { return m_channels[i].name; }
+    SerialReader *reader(int i) const { return m_channels[i].reader; }
+    SpscRingBuffer<Sample> *buffer(int i) const { return m_channels[i].buffer.get(); }
+
+    QVector<SpscRingBuffer<Sample> *> recordBuffers() const;   // 各串口的录制缓冲区
+    void setRecording(bool enabled);                            // 开始/停止向录制缓冲区写入
+
+    quint64 droppedSamples() const;     // 所有串口丢弃的采样数之和
+    quint64 recordDroppedSamples() const;   // 所有串口未能录制的采样数之和
+    quint64 parseErrors() const;        // 所有串口解析失败的帧数之和
+    quint64 crcErrors() const;          // 所有串口CRC校验失败的包数之和
+
+signals:
+    void errorOccurred(const QString &message);
+
+private:
+    struct Channel
+    {
+        QString                                 name;
+        SerialReader                            *reader;
+        std::unique_ptr<SpscRingBuffer<Sample>> buffer;     // 读取线程写，GUI线程读
+        std::unique_ptr<SpscRingBuffer<Sample>> record;     // 读取线程写，写盘线程读
+    };
+
+    void release();     // 关闭串口并释放所有通道
+
+    std::vector<Channel>                    m_channels;
+    std::vector<std::unique_ptr<QThread>>   m_threads;  // 工作线程，按需创建
+};
+
+#endif // CHANNELMANAGER_H
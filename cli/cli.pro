@@ -0,0 +1,25 @@
+# 无界面采集程序：不依赖QtWidgets和QCustomPlot，用于无显示器的实验室电脑长时间测试。
+
+QT       += core
+QT       -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = sensorcli
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../acquisition.pri)
+
+SOURCES += \
+    headlessmonitor.cpp \
+    main.cpp
+
+HEADERS += \
+    headlessmonitor.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
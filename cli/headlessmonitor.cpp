@@ -0,0 +1,231 @@
+#include "headlessmonitor.h"
+
+#include <cstdio>
+
+/**
+ * @brief 构造函数。
+ * @param parent 父对象指针。
+ */
+HeadlessMonitor::HeadlessMonitor(QObject *parent)
+    : QObject(parent)
+{
+    connect(&m_channelManager, &ChannelManager::errorOccurred, this, [](const QString &message) {
+        fprintf(stderr, "error: %s\n", qPrintable(message));
+    });
+
+    m_drainTimer.setTimerType(Qt::PreciseTimer);
+    m_drainTimer.setInterval(CLI_DRAIN_INTERVAL);
+    connect(&m_drainTimer, &QTimer::timeout, this, &HeadlessMonitor::drain);
+    connect(&m_metricsTimer, &QTimer::timeout, this, [this]() { writeMetrics(false); });
+}
+
+/**
+ * @brief 析构函数，停止采集和写盘线程。
+ */
+HeadlessMonitor::~HeadlessMonitor()
+{
+    stop();
+    m_recorderThread.quit();
+    m_recorderThread.wait();
+}
+
+/**
+ * @brief 打开输出文件和全部串口并开始采集。
+ * @param p 串口配置。
+ * @param options 输出与运行选项。
+ * @param errorString 失败时写入原因，可为nullptr。
+ * @return 成功返回true。
+ */
+bool HeadlessMonitor::start(const SerialSettings &p, const Options &options, QString *errorString)
+{
+    m_options = options;
+    if (!TriggerConfig::parse(p.trigger, &m_trigger, errorString))
+        return false;
+
+    auto openOutput = [&](QFile &file, const QString &name, FILE *standard) {
+        bool ok;
+        if (name == QLatin1String("-")) {
+            ok = file.open(standard, QIODevice::WriteOnly);
+        } else {
+            file.setFileName(name);
+            ok = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        }
+        if (!ok && errorString)
+            *errorString = name + ": " + file.errorString();
+        return ok;
+    };
+    if (!m_options.samplesFile.isEmpty() && !openOutput(m_samplesOut, m_options.samplesFile, stdout))
+        return false;
+    if (!openOutput(m_metricsOut, m_options.metricsFile, stderr))
+        return false;
+
+    if (m_samplesOut.isOpen())
+        m_samplesOut.write("port,column,time,value\n");
+    m_metricsOut.write("elapsed,port,column,count,min,max,current,before_rise,after_rise,"
+                       "rise_detected,rise_time,triggers,trigger_time,dropped,parse_errors,crc_errors,final\n");
+    m_metricsOut.flush();
+
+    m_channelManager.open(p);
+    m_channels.clear();
+    m_channelIndex.assign(static_cast<std::size_t>(m_channelManager.count()), std::vector<int>());
+
+    if (!m_options.recordFile.isEmpty()) {
+        m_recorder = new RecordingWriter;
+        m_recorder->moveToThread(&m_recorderThread);
+        connect(&m_recorderThread, &QThread::finished, m_recorder, &QObject::deleteLater);
+        connect(m_recorder, &RecordingWriter::errorOccurred, this, [](const QString &message) {
+            fprintf(stderr, "error: %s\n", qPrintable(message));
+        });
+        m_recorderThread.start();
+
+        const QString fileName = m_options.recordFile;
+        const QVector<SpscRingBuffer<Sample> *> buffers = m_channelManager.recordBuffers();
+        RecordingWriter *recorder = m_recorder;
+        QMetaObject::invokeMethod(recorder, [recorder, fileName, p, buffers]() { recorder->start(fileName, p, buffers); },
+                                  Qt::BlockingQueuedConnection);
+        m_channelManager.setRecording(true);
+    }
+
+    m_elapsed.start();
+    m_drainTimer.start();
+    if (m_options.metricsInterval > 0)
+        m_metricsTimer.start(static_cast<int>(m_options.metricsInterval * 1000));
+    if (m_options.duration > 0)
+        QTimer::singleShot(static_cast<int>(m_options.duration * 1000), this, &HeadlessMonitor::stop);
+    m_running = true;
+    return true;
+}
+
+/**
+ * @brief 停止采集，写出剩余数据和最终指标。
+ */
+void HeadlessMonitor::stop()
+{
+    if (!m_running)
+        return;
+    m_running = false;
+
+    m_drainTimer.stop();
+    m_metricsTimer.stop();
+    m_channelManager.close();
+    drain();
+
+    if (m_recorder) {
+        m_channelManager.setRecording(false);
+        QMetaObject::invokeMethod(m_recorder, &RecordingWriter::stop, Qt::BlockingQueuedConnection);
+    }
+
+    writeMetrics(true);
+    m_samplesOut.close();
+    m_metricsOut.close();
+    emit finished();
+}
+
+/**
+ * @brief 查找采样点所属的通道，第一次出现的串口列会新建统计。
+ * @return 通道在m_channels中的下标，串口序号无效时返回-1。
+ */
+int HeadlessMonitor::channelFor(const Sample &s)
+{
+    if (s.port >= m_channelIndex.size())
+        return -1;
+    std::vector<int> &columns = m_channelIndex[s.port];
+    if (s.column < columns.size() && columns[s.column] >= 0)
+        return columns[s.column];
+
+    if (s.column >= columns.size())
+        columns.resize(s.column + 1, -1);
+    const int index = static_cast<int>(m_channels.size());
+    m_channels.push_back(ChannelStats());
+    m_channels.back().port = s.port;
+    m_channels.back().column = s.column;
+    m_channels.back().trigger.setConfig(m_trigger);
+    columns[s.column] = index;
+    return index;
+}
+
+/**
+ * @brief 取出各串口缓冲区中的全部采样点，更新统计并写出采样点。
+ */
+void HeadlessMonitor::drain()
+{
+    const bool writeSamples = m_samplesOut.isOpen();
+    m_line.resize(0);
+
+    for (int port = 0; port < m_channelManager.count(); ++port)
+    {
+        m_channelManager.buffer(port)->drain([&](const Sample &s) {
+            const int c = channelFor(s);
+            if (c < 0)
+                return;
+            ChannelStats &channel = m_channels[c];
+            if (channel.count == 0 || s.value > channel.max)
+                channel.max = s.value;
+            if (channel.count == 0 || s.value < channel.min)
+                channel.min = s.value;
+            channel.current = s.value;
+            ++channel.count;
+            if (!channel.trigger.enabled()) {
+                channel.analyzer.addSample(s.time, s.value);
+            } else if (channel.trigger.addSample(s)) {
+                channel.analyzer.reset();
+                for (const Sample &captured : channel.trigger.capture())
+                    channel.analyzer.addSample(captured.time, captured.value);
+            }
+
+            if (writeSamples) {
+                m_line += QByteArray::number(s.port);
+                m_line += ',';
+                m_line += QByteArray::number(s.column);
+                m_line += ',';
+                m_line += QByteArray::number(s.time, 'f', 6);
+                m_line += ',';
+                m_line += QByteArray::number(s.value, 'g', 10);
+                m_line += '\n';
+            }
+        });
+    }
+
+    if (writeSamples && !m_line.isEmpty()) {
+        m_samplesOut.write(m_line);
+        m_samplesOut.flush();
+    }
+}
+
+/**
+ * @brief 以CSV格式输出每个通道的指标，每个通道一行。
+ * @param final 是否为结束时的最终指标。
+ */
+void HeadlessMonitor::writeMetrics(bool final)
+{
+    const double elapsed = m_elapsed.nsecsElapsed() * 1e-9;
+    QByteArray out;
+    for (const ChannelStats &channel : m_channels)
+    {
+        const SerialReader *reader = channel.port < m_channelManager.count()
+                ? m_channelManager.reader(channel.port) : nullptr;
+        out += QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,")
+                .arg(elapsed, 0, 'f', 3)
+                .arg(channel.port)
+                .arg(channel.column)
+                .arg(channel.count)
+                .arg(channel.min, 0, 'g', 10)
+                .arg(channel.max, 0, 'g', 10)
+                .arg(channel.current, 0, 'g', 10)
+                .arg(channel.analyzer.beforeRise(), 0, 'g', 10)
+                .arg(channel.analyzer.afterRise(), 0, 'g', 10)
+                .toLatin1();
+        out += QString("%1,%2,%3,%4,%5,%6,%7,%8\n")
+                .arg(channel.analyzer.riseDetected() ? 1 : 0)
+                .arg(channel.analyzer.riseTime(), 0, 'g', 10)
+                .arg(channel.trigger.captureCount())
+                .arg(channel.trigger.triggerTime(), 0, 'f', 6)
+                .arg(reader ? reader->droppedSamples() : 0)
+                .arg(reader ? reader->parseErrors() : 0)
+                .arg(reader ? reader->crcErrors() : 0)
+                .arg(final ? 1 : 0)
+                .toLatin1();
+    }
+    m_metricsOut.write(out);
+    m_metricsOut.flush();
+}
@@ -0,0 +1,86 @@
+#ifndef HEADLESSMONITOR_H
+#define HEADLESSMONITOR_H
+
+#include <QObject>
+#include <QFile>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include <vector>
+
+#include "serialsettings.h"
+#include "channelmanager.h"
+#include "recording.h"
+#include "riseanalyzer.h"
+#include "trigger.h"
+
+#define CLI_DRAIN_INTERVAL 20       // 取数据周期（毫秒）
+#define CLI_METRICS_INTERVAL 1.0    // 默认指标输出周期（秒）
+
+/**
+ * @brief 无界面采集类，对应MainWindow中除绘图以外的部分。
+ *
+ * 定时从各串口的缓冲区取出采样点，逐点更新各通道的最值和稳态值/上升时间，
+ * 采样点和统计指标以CSV格式写入文件或标准输出，便于脚本处理。
+ */
+class HeadlessMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options
+    {
+        QString samplesFile = QStringLiteral("-");  // 采样点输出，"-"为标准输出，空为不输出
+        QString metricsFile = QStringLiteral("-");  // 指标输出，"-"为标准错误
+        QString recordFile;                         // 二进制录制文件，空为不录制
+        double metricsInterval = CLI_METRICS_INTERVAL;
+        double duration = 0;                        // 运行时长（秒），0为一直运行
+    };
+
+    explicit HeadlessMonitor(QObject *parent = nullptr);
+    ~HeadlessMonitor();
+
+    bool start(const SerialSettings &p, const Options &options, QString *errorString = nullptr);
+    void stop();    // 关闭串口，写出剩余数据和最终指标后发出finished()
+
+signals:
+    void finished();
+
+private:
+    /* 单个通道（串口的一列）的统计 */
+    struct ChannelStats
+    {
+        int             port = 0;
+        int             column = 0;
+        quint64         count = 0;
+        double          min = 0;
+        double          max = 0;
+        double          current = 0;
+        RiseAnalyzer    analyzer;       // 设置触发时只分析最近一次捕获的数据
+        TriggerEngine   trigger;
+    };
+
+    void drain();                       // 取出所有缓冲区中的数据
+    void writeMetrics(bool final);      // 输出每个通道的指标
+    int channelFor(const Sample &s);    // 采样点所属通道，不存在时建立
+
+    ChannelManager      m_channelManager;
+    QThread             m_recorderThread;
+    RecordingWriter     *m_recorder = nullptr;
+
+    Options             m_options;
+    TriggerConfig       m_trigger;
+    QFile               m_samplesOut;
+    QFile               m_metricsOut;
+    QByteArray          m_line;             // 输出缓存，重复使用
+    QTimer              m_drainTimer;
+    QTimer              m_metricsTimer;
+    QElapsedTimer       m_elapsed;
+    bool                m_running = false;
+
+    std::vector<ChannelStats>       m_channels;
+    std::vector<std::vector<int>>   m_channelIndex;     // [串口][列] -> m_channels下标
+};
+
+#endif // HEADLESSMONITOR_H
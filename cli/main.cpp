@@ -0,0 +1,175 @@
+#include "headlessmonitor.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTimer>
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+
+static std::atomic<bool> interrupted{false};
+
+static void handleSignal(int)
+{
+    interrupted.store(true);
+}
+
+/**
+ * @brief 从命令行参数填写串口配置，未给出的参数与SettingsDialog的默认值一致。
+ * @return 参数非法时返回false并写入原因。
+ */
+static bool parseSettings(const QCommandLineParser &parser, SerialSettings &p, QString &error)
+{
+    p.portNames = parser.values(QStringLiteral("port"));
+    if (p.portNames.size() == 1) {
+        p.portNames = p.portNames.first().split(QLatin1Char(','));
+        p.portNames.removeAll(QString());   // 跳过空项，QString::SkipEmptyParts自Qt 5.14起已过时
+    }
+    if (p.portNames.isEmpty()) {
+        error = QStringLiteral("at least one --port is required");
+        return false;
+    }
+    p.name = p.portNames.first();
+
+    bool ok = true;
+    p.baudRate = parser.value(QStringLiteral("baud")).toInt(&ok);
+    if (!ok || p.baudRate <= 0) {
+        error = QStringLiteral("invalid baud rate");
+        return false;
+    }
+    p.stringBaudRate = QString::number(p.baudRate);
+
+    const int dataBits = parser.value(QStringLiteral("data-bits")).toInt(&ok);
+    if (!ok || dataBits < 5 || dataBits > 8) {
+        error = QStringLiteral("invalid data bits");
+        return false;
+    }
+    p.dataBits = static_cast<QSerialPort::DataBits>(dataBits);
+    p.stringDataBits = QString::number(dataBits);
+
+    const QString parity = parser.value(QStringLiteral("parity"));
+    if (parity == QLatin1String("none"))
+        p.parity = QSerialPort::NoParity;
+    else if (parity == QLatin1String("even"))
+        p.parity = QSerialPort::EvenParity;
+    else if (parity == QLatin1String("odd"))
+        p.parity = QSerialPort::OddParity;
+    else if (parity == QLatin1String("mark"))
+        p.parity = QSerialPort::MarkParity;
+    else if (parity == QLatin1String("space"))
+        p.parity = QSerialPort::SpaceParity;
+    else {
+        error = QStringLiteral("invalid parity");
+        return false;
+    }
+    p.stringParity = parity;
+
+    const QString stopBits = parser.value(QStringLiteral("stop-bits"));
+    if (stopBits == QLatin1String("1"))
+        p.stopBits = QSerialPort::OneStop;
+    else if (stopBits == QLatin1String("1.5"))
+        p.stopBits = QSerialPort::OneAndHalfStop;
+    else if (stopBits == QLatin1String("2"))
+        p.stopBits = QSerialPort::TwoStop;
+    else {
+        error = QStringLiteral("invalid stop bits");
+        return false;
+    }
+    p.stringStopBits = stopBits;
+
+    const QString flow = parser.value(QStringLiteral("flow"));
+    if (flow == QLatin1String("none"))
+        p.flowControl = QSerialPort::NoFlowControl;
+    else if (flow == QLatin1String("rtscts"))
+        p.flowControl = QSerialPort::HardwareControl;
+    else if (flow == QLatin1String("xonxoff"))
+        p.flowControl = QSerialPort::SoftwareControl;
+    else {
+        error = QStringLiteral("invalid flow control");
+        return false;
+    }
+    p.stringFlowControl = flow;
+
+    const QString protocol = parser.value(QStringLiteral("protocol"));
+    if (protocol == QLatin1String("text"))
+        p.protocol = SerialSettings::ProtocolText;
+    else if (protocol == QLatin1String("binary"))
+        p.protocol = SerialSettings::ProtocolBinary;
+    else {
+        error = QStringLiteral("invalid protocol");
+        return false;
+    }
+    p.stringProtocol = protocol;
+
+    p.localEchoEnabled = false;
+    p.deviceTimestamps = parser.isSet(QStringLiteral("device-timestamps"));
+    p.windowMode = SerialSettings::WindowAll;
+    p.windowSize = 0;
+    p.trigger = parser.value(QStringLiteral("trigger"));
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("sensorcli"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Headless serial acquisition. Writes samples as CSV (port,column,time,value) "
+        "and per-channel metrics including steady state and rise time."));
+    parser.addHelpOption();
+    parser.addOptions({
+        {{"p", "port"}, "Serial port; repeat or separate with commas for several ports.", "name"},
+        {{"b", "baud"}, "Baud rate.", "rate", "115200"},
+        {"data-bits", "Data bits (5-8).", "bits", "8"},
+        {"parity", "none, even, odd, mark or space.", "parity", "none"},
+        {"stop-bits", "1, 1.5 or 2.", "bits", "1"},
+        {"flow", "none, rtscts or xonxoff.", "flow", "none"},
+        {"protocol", "text or binary.", "protocol", "text"},
+        {"device-timestamps", "Frames start with a device timestamp (text protocol)."},
+        {{"o", "output"}, "Sample CSV file, - for stdout.", "file", "-"},
+        {"no-samples", "Do not write samples, only metrics."},
+        {{"m", "metrics"}, "Metrics CSV file, - for stderr.", "file", "-"},
+        {"metrics-interval", "Seconds between metric rows, 0 for final only.", "seconds", "1"},
+        {"record", "Also write a binary recording (.tsrec).", "file"},
+        {"trigger", "Analyze only the samples around each trigger, e.g. edge:level=30;hyst=0.2;pre=1000;post=5000 "
+                    "(types level, edge, slope, window).", "spec"},
+        {{"d", "duration"}, "Stop after this many seconds, 0 to run until interrupted.", "seconds", "0"},
+    });
+    parser.process(a);
+
+    SerialSettings settings;
+    QString error;
+    if (!parseSettings(parser, settings, error)) {
+        fprintf(stderr, "error: %s\n", qPrintable(error));
+        return 1;
+    }
+
+    HeadlessMonitor::Options options;
+    options.samplesFile = parser.isSet(QStringLiteral("no-samples")) ? QString() : parser.value(QStringLiteral("output"));
+    options.metricsFile = parser.value(QStringLiteral("metrics"));
+    options.recordFile = parser.value(QStringLiteral("record"));
+    options.metricsInterval = parser.value(QStringLiteral("metrics-interval")).toDouble();
+    options.duration = parser.value(QStringLiteral("duration")).toDouble();
+
+    HeadlessMonitor monitor;
+    QObject::connect(&monitor, &HeadlessMonitor::finished, &a, &QCoreApplication::quit, Qt::QueuedConnection);
+    if (!monitor.start(settings, options, &error)) {
+        fprintf(stderr, "error: %s\n", qPrintable(error));
+        return 1;
+    }
+
+    // Ctrl+C时正常结束，写出最终指标
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    QTimer signalTimer;
+    QObject::connect(&signalTimer, &QTimer::timeout, &monitor, [&monitor]() {
+        if (interrupted.load())
+            monitor.stop();
+    });
+    signalTimer.start(100);
+
+    return a.exec();
+}
@@ -3,7 +3,14 @@
 #include "qcustomplot.h"
 
 #include <QDebug>
-#include <stdlib.h>
+#include <QMessageBox>
+#include <QFileDialog>
+#include <QComboBox>
+#include <QElapsedTimer>
+#include <QLabel>
+
+#include <algorithm>
+#include <cmath>
 
 /**
  * @brief 构造函数，初始化主窗口和UI组件。
@@ -18,117 +25,274 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->actionOpen_Serial, &QAction::triggered, this, &MainWindow::openSerialPort);
     connect(ui->actionClose_Serial, &QAction::triggered, this, &MainWindow::closeSerialPort);
     connect(ui->actionConfig, &QAction::triggered, this, &MainWindow::on_btnConfig_clicked);
-
-    m_serial = new QSerialPort();
-    connect(m_serial, &QSerialPort::readyRead, this, &MainWindow::readData);
+    connect(ui->actionRecord, &QAction::toggled, this, &MainWindow::toggleRecording);
+    connect(ui->actionOpen_Recording, &QAction::triggered, this, &MainWindow::openRecording);
+    connect(ui->actionRearm_Trigger, &QAction::triggered, this, &MainWindow::rearmTrigger);
+    connect(ui->actionThreaded_Rendering, &QAction::toggled, this, &MainWindow::setThreadedRendering);
+    connect(ui->actionOpenGL, &QAction::toggled, this, &MainWindow::setOpenGlRendering);
+
+    /* 通道选择 */
+    m_channelBox = new QComboBox(this);
+    m_channelBox->setToolTip(tr("Channel shown in the value fields"));
+    ui->toolBar->addWidget(m_channelBox);
+    connect(m_channelBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::showChannel);
+
+    /* 采集通道初始化 */
+    connect(&m_channelManager, &ChannelManager::errorOccurred, this, [this](const QString &message) {
+        QMessageBox::critical(this, tr("Error"), message);
+    });
+
+    /* 写盘线程初始化 */
+    m_recorder = new RecordingWriter;
+    m_recorder->moveToThread(&m_recorderThread);
+    connect(&m_recorderThread, &QThread::finished, m_recorder, &QObject::deleteLater);
+    connect(m_recorder, &RecordingWriter::errorOccurred, this, [this](const QString &message) {
+        ui->actionRecord->setChecked(false);
+        QMessageBox::critical(this, tr("Error"), message);
+    });
+    m_recorderThread.start();
+
+    m_renderTimer.setTimerType(Qt::PreciseTimer);
+    setRenderRate(RENDER_FPS);
+    connect(&m_renderTimer, &QTimer::timeout, this, &MainWindow::renderFrame);
+    connect(&m_replayTimer, &QTimer::timeout, this, &MainWindow::replayFrame);
+
+    /* 运行指标 */
+    m_telemetryLabel = new QLabel(this);
+    ui->statusbar->addPermanentWidget(m_telemetryLabel);
+    m_telemetryOverlay = new QCPItemText(ui->m_plot);
+    m_telemetryOverlay->position->setType(QCPItemPosition::ptAxisRectRatio);
+    m_telemetryOverlay->position->setCoords(0.01, 0.01);
+    m_telemetryOverlay->setPositionAlignment(Qt::AlignTop | Qt::AlignLeft);
+    m_telemetryOverlay->setTextAlignment(Qt::AlignLeft);
+    QFont telemetryFont;
+    telemetryFont.setPixelSize(10);
+    m_telemetryOverlay->setFont(telemetryFont);
+    m_telemetryOverlay->setBrush(QColor(255, 255, 255, 200));
+    m_telemetryOverlay->setPadding(QMargins(4, 2, 4, 2));
+    m_telemetryOverlay->setVisible(false);
+    connect(ui->actionTelemetry, &QAction::toggled, this, &MainWindow::showTelemetryOverlay);
+
+    /* 触发时刻标记 */
+    m_triggerLine = new QCPItemStraightLine(ui->m_plot);
+    m_triggerLine->setPen(QPen(Qt::darkRed, 1, Qt::DashLine));
+    m_triggerLine->setVisible(false);
+    connect(ui->m_plot, &QCustomPlot::beforeReplot, this, [this]() { m_telemetry.replotStarted(); });
+    connect(ui->m_plot, &QCustomPlot::afterReplot, this, [this]() { m_telemetry.replotFinished(); });
+    connect(ui->m_plot, &QCustomPlot::afterRender, this, [this](double ms) { m_telemetry.rasterFinished(ms); });
 
     connect(ui->m_plot, SIGNAL(mousePress(QMouseEvent *)), this, SLOT(slot_SameTimeMousePressEvent4Plot(QMouseEvent *)));
 
     /* plot初始化 */
     ui->m_plot->xAxis->setRange(0, TIME_BASE);
     ui->m_plot->yAxis->setRange(Y_MIN, Y_MAX);
-    max = Y_MIN;
-    min = Y_MAX;
+    /* 背景、网格、坐标轴和图例层缓存为位图，只在范围或尺寸变化时重绘，每帧只重绘数据层 */
+    foreach (const QString &name, QStringList() << "background" << "grid" << "axes" << "legend")
+        ui->m_plot->layer(name)->setMode(QCPLayer::lmBuffered);
+    /* 曲线单独放在增量层：坐标范围不变时每帧只补画新追加的线段 */
+    ui->m_plot->addLayer("data", ui->m_plot->layer("main"), QCustomPlot::limBelow);
+    ui->m_plot->layer("data")->setMode(QCPLayer::lmIncremental);
+}
+
+/**
+ * @brief 设置重绘帧率，两帧之间到达的数据会合并绘制。
+ * @param fps 每秒重绘次数，限制在1~120之间。
+ */
+void MainWindow::setRenderRate(int fps)
+{
+    m_renderRate = qBound(1, fps, 120);
+    m_renderTimer.setInterval(1000 / m_renderRate);
+    m_replayTimer.setInterval(1000 / m_renderRate);
 }
 
 /**
- * @brief 打开串口并开始绘图。
+ * @brief 打开配置中的全部串口并开始绘图。
  */
 void MainWindow::openSerialPort()
 {
-    const SettingsDialog::Settings p = settingsDialog.settings();
+    stopReplay();
 
-    m_serial->setPortName(p.name);
-    m_serial->setBaudRate(p.baudRate);
-    m_serial->setDataBits(p.dataBits);
-    m_serial->setParity(p.parity);
-    m_serial->setStopBits(p.stopBits);
-    m_serial->setFlowControl(p.flowControl);
+    // 通道重建前停止录制，写盘线程不再访问旧的缓冲区
+    ui->actionRecord->setChecked(false);
 
-    m_serial->open(QIODevice::ReadWrite);
+    // 串口在各工作线程中打开，此处不等待
+    m_channelManager.open(settingsDialog.settings());
 
-    startPlot();
+    QStringList names;
+    for (int i = 0; i < m_channelManager.count(); ++i)
+        names.append(m_channelManager.portName(i));
+    startPlot(names);
+    m_telemetry.reset();
+    m_renderTimer.start();
 }
 
 /**
- * @brief 关闭串口并计算稳态值和上升时间。
+ * @brief 关闭串口并显示最终的稳态值和上升时间。
  */
 void MainWindow::closeSerialPort()
 {
-    if (m_serial->isOpen())
-        m_serial->close();
+    stopReplay();
+
+    // 等待各工作线程关闭串口，之后缓冲区不会再有新数据
+    m_channelManager.close();
+    m_renderTimer.stop();
+    readData();     // 取出剩余数据
 
     // outputPlotData();
     calculateSteadyStateAndRiseTime();
 }
 
 /**
- * @brief 计算稳态值和上升时间。
+ * @brief 开始或停止录制，录制期间各读取线程把采样点同时写入录制缓冲区。
+ * @param checked true开始录制，false停止录制。
  */
-void MainWindow::calculateSteadyStateAndRiseTime()
+void MainWindow::toggleRecording(bool checked)
 {
-    // 获取图形对象
-    QCPGraph *graph = ui->m_plot->graph(0);
-    if (graph)
-    {
-        // 获取数据点
-        const QCPDataMap *dataMap = graph->data();
-        if (dataMap->isEmpty())
-            return;
+    if (!checked) {
+        m_channelManager.setRecording(false);
+        QMetaObject::invokeMethod(m_recorder, &RecordingWriter::stop, Qt::BlockingQueuedConnection);
+        return;
+    }
 
-        // 计算开始和结束时的平均值作为稳态值
-        double startSum = 0;
-        double endSum = 0;
-        int startCount = 0;
-        int endCount = 0;
-        int totalCount = dataMap->size();
-        int startRange = totalCount * 0.1; // 前10%的数据点
-        int endRange = totalCount * 0.1;   // 后10%的数据点
-
-        int index = 0;
-        for (auto it = dataMap->constBegin(); it != dataMap->constEnd(); ++it, ++index)
-        {
-            if (index < startRange)
-            {
-                startSum += it.value().value;
-                startCount++;
-            }
-            if (index >= totalCount - endRange)
-            {
-                endSum += it.value().value;
-                endCount++;
-            }
-        }
+    if (m_channelManager.count() == 0) {
+        ui->actionRecord->setChecked(false);
+        return;
+    }
 
-        double startSteadyState = startSum / startCount;
-        double endSteadyState = endSum / endCount;
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Record"), QString(),
+                                                          tr("Recordings (*.tsrec)"));
+    if (fileName.isEmpty()) {
+        ui->actionRecord->setChecked(false);
+        return;
+    }
 
-        // 计算上升时间
-        double riseTime = 0;
-        bool rising = false;
-        for (auto it = dataMap->constBegin(); it != dataMap->constEnd(); ++it)
-        {
-            if (!rising && it.value().value > startSteadyState+0.3)
-            {
-                rising = true;
-                riseTime = it.key();
-                qDebug() << "Start Time:" << it.key();
-            }
-            if (rising && it.value().value >= endSteadyState)
-            {
-                riseTime = it.key() - riseTime;
-                qDebug() << "End Time:" << it.key();
-                break;
-            }
-        }
-        ui->lineEdit_risetime->setText(QString::number(riseTime, 'f', 1));
-        ui->lineEdit_beforerise->setText(QString::number(startSteadyState, 'f', 2));
-        ui->lineEdit_afterrise->setText(QString::number(endSteadyState, 'f', 2));
+    // 写盘线程先写好文件头并清空缓冲区，再让读取线程开始写入
+    const SettingsDialog::Settings p = settingsDialog.settings();
+    const QVector<SpscRingBuffer<Sample> *> buffers = m_channelManager.recordBuffers();
+    QMetaObject::invokeMethod(m_recorder, [this, fileName, p, buffers]() { m_recorder->start(fileName, p, buffers); },
+                              Qt::BlockingQueuedConnection);
+    m_channelManager.setRecording(true);
+}
 
-        // qDebug() << "Start Steady State:" << startSteadyState;
-        // qDebug() << "End Steady State:" << endSteadyState;
-        // qDebug() << "Rise Time:" << riseTime;
+/**
+ * @brief 打开录制文件并回放，数据直接取自内存映射，不做文本解析。
+ *
+ * 文件在回放期间保持映射，由回放定时器每帧处理一段，界面不会因文件很大而停止响应。
+ */
+void MainWindow::openRecording()
+{
+    const QString fileName = QFileDialog::getOpenFileName(this, tr("Open Recording"), QString(),
+                                                          tr("Recordings (*.tsrec);;All files (*)"));
+    if (fileName.isEmpty())
+        return;
+
+    closeSerialPort();
+    clearPlot();
+
+    QString error;
+    if (!m_recording.open(fileName, &error)) {
+        QMessageBox::critical(this, tr("Error"), error);
+        return;
     }
+
+    QStringList names = m_recording.settings().portNames;
+    if (names.isEmpty())
+        names.append(m_recording.settings().name);
+    startPlot(names);
+    m_replayName = tr("%1：%2").arg(fileName).arg(names.join(QLatin1Char(',')));
+    m_replayPos = 0;
+    m_replayTimer.start();
+    replayFrame();
+}
+
+/**
+ * @brief 回放一帧：与实时采集相同，逐点计入分析器和触发器，合并加入曲线后重绘一次。
+ *
+ * 每帧最多用半个帧间隔处理数据，其余时间留给界面事件；处理完全部采样点后解除映射。
+ */
+void MainWindow::replayFrame()
+{
+    const Sample *samples = m_recording.samples();
+    const qint64 count = m_recording.count();
+    const qint64 budgetNs = qint64(m_replayTimer.interval()) * 1000000 / 2;
+    QElapsedTimer clock;
+    clock.start();
+    while (m_replayPos < count) {
+        const qint64 end = std::min(count, m_replayPos + REPLAY_BLOCK);
+        for (; m_replayPos < end; ++m_replayPos)
+            addSample(samples[m_replayPos]);
+        if (clock.nsecsElapsed() >= budgetNs)
+            break;
+    }
+
+    commitFrame();
+    if (m_replayPos >= count) {
+        ui->statusbar->showMessage(tr("回放 %1，%2 个采样点").arg(m_replayName).arg(count));
+        stopReplay();
+    } else {
+        ui->statusbar->showMessage(tr("回放 %1，%2 / %3 个采样点").arg(m_replayName).arg(m_replayPos).arg(count));
+    }
+    updateTimeAxis();
+    ui->m_plot->replot();
+}
+
+/**
+ * @brief 停止回放并解除录制文件的映射，已载入曲线的数据保留。
+ */
+void MainWindow::stopReplay()
+{
+    m_replayTimer.stop();
+    m_recording.close();
+    m_replayPos = 0;
+}
+
+/**
+ * @brief 切换显示统计量的通道。
+ * @param i 通道序号。
+ */
+void MainWindow::showChannel(int i)
+{
+    if (i < 0)
+        return;
+    m_shownChannel = i;
+    updateChannelInfo();
+}
+
+/**
+ * @brief 刷新所选通道的当前值、最值、稳态值和上升时间。
+ */
+void MainWindow::updateChannelInfo()
+{
+    if (m_shownChannel >= static_cast<int>(m_channels.size()))
+        return;
+    const PlotChannel &channel = m_channels[m_shownChannel];   // 通道在收到第一个点时才建立，总有数据
+
+    ui->lineEdit_maxvalue->setText(QString::number(channel.max, 'f', 2));
+    ui->lineEdit_minvalue->setText(QString::number(channel.min, 'f', 2));
+    ui->lineEdit_current->setText(QString::number(channel.current, 'f', 2));
+    calculateSteadyStateAndRiseTime();
+}
+
+/**
+ * @brief 显示所选通道的稳态值和上升时间。
+ *
+ * 统计量由各通道的分析器随数据到达逐点更新，这里只读取结果，不遍历历史数据。
+ */
+void MainWindow::calculateSteadyStateAndRiseTime()
+{
+    if (m_shownChannel >= static_cast<int>(m_channels.size()))
+        return;
+    const RiseAnalyzer &analyzer = m_channels[m_shownChannel].analyzer;
+    if (!analyzer.hasData())
+        return;
+
+    ui->lineEdit_risetime->setText(QString::number(analyzer.riseTime(), 'f', 1));
+    ui->lineEdit_beforerise->setText(QString::number(analyzer.beforeRise(), 'f', 2));
+    ui->lineEdit_afterrise->setText(QString::number(analyzer.afterRise(), 'f', 2));
+
+    // qDebug() << "Start Steady State:" << analyzer.beforeRise();
+    // qDebug() << "End Steady State:" << analyzer.afterRise();
+    // qDebug() << "Rise Time:" << analyzer.riseTime();
 }
 
 /**
@@ -136,31 +300,98 @@ void MainWindow::calculateSteadyStateAndRiseTime()
  */
 void MainWindow::outputPlotData()
 {
-    // 获取图形对象
-    QCPGraph *graph = ui->m_plot->graph(0);
-    if (graph)
+    for (int g = 0; g < ui->m_plot->graphCount(); ++g)
     {
         // 获取数据点
-        const QCPDataMap *dataMap = graph->data();
-        for (auto it = dataMap->constBegin(); it != dataMap->constEnd(); ++it)
+        const QCPDataVector *dataVector = ui->m_plot->graph(g)->dataVector();
+        for (int i = 0; i < dataVector->size(); ++i)
         {
-            double x = it.key();
-            double y = it.value().value;
-            qDebug() << "x:" << x << ", y:" << y;
+            double x = dataVector->key(i);
+            double y = dataVector->value(i);
+            qDebug() << "graph:" << g << "x:" << x << ", y:" << y;
         }
     }
 }
 
 /**
- * @brief 开始绘图。
+ * @brief 开始绘图，清除旧曲线。各通道的曲线在收到第一个采样点时建立。
+ * @param names 各串口名称。
  */
-void MainWindow::startPlot()
+void MainWindow::startPlot(const QStringList &names)
 {
+    const SettingsDialog::Settings p = settingsDialog.settings();
+    m_windowMode = p.windowMode;
+    m_windowSize = p.windowSize;
+    if (m_windowMode == SerialSettings::WindowSweep && m_windowSize <= 0)
+        m_windowSize = TIME_BASE;
+    time = 0;
+
+    QString triggerError;
+    if (!TriggerConfig::parse(p.trigger, &m_trigger, &triggerError)) {
+        m_trigger = TriggerConfig();
+        QMessageBox::warning(this, tr("Trigger"), triggerError);
+    }
+
+    clearPlot();
     ui->m_plot->xAxis->setRange(0, TIME_BASE);
     ui->m_plot->yAxis->setRange(Y_MIN, Y_MAX);
-    ui->m_plot->addGraph();
-    ui->m_plot->graph(0)->setAntialiased(true); // 启用抗锯齿
-    ui->m_plot->graph(0)->setAdaptiveSampling(true); // 启用自适应采样
+    updateTimeAxis();
+
+    m_portNames = names;
+    m_channelIndex.assign(static_cast<std::size_t>(names.size()), std::vector<int>());
+    m_shownChannel = 0;
+}
+
+/**
+ * @brief 查找采样点所属的通道，第一次出现的串口列会新建一条曲线。
+ * @param s 采样点。
+ * @return 通道在m_channels中的下标，串口序号无效时返回-1。
+ */
+int MainWindow::channelFor(const Sample &s)
+{
+    if (s.port >= m_channelIndex.size())
+        return -1;
+    std::vector<int> &columns = m_channelIndex[s.port];
+    if (s.column < columns.size() && columns[s.column] >= 0)
+        return columns[s.column];
+
+    if (s.column >= columns.size())
+        columns.resize(s.column + 1, -1);
+
+    const int index = static_cast<int>(m_channels.size());
+    const QString name = s.column == 0 ? m_portNames.at(s.port)
+                                       : QString("%1 #%2").arg(m_portNames.at(s.port)).arg(s.column + 1);
+
+    QCPGraph *graph = ui->m_plot->addGraph();
+    graph->setName(name);
+    graph->setPen(QPen(QColor::fromHsv((210 + index * 137) % 360, 220, 200)));
+    graph->setDataBackend(QCPGraph::dbVector); // 连续数组存储，追加数据为O(1)
+    if (m_windowMode == SerialSettings::WindowSamples)
+        graph->dataVector()->reserve(2 * static_cast<int>(m_windowSize)); // 窗口内存一次分配到位
+    graph->setAntialiased(true); // 启用抗锯齿
+    graph->setAdaptiveSampling(true); // 启用自适应采样
+    graph->setLayer("data");
+
+    m_channels.push_back(PlotChannel());
+    m_channels.back().graph = graph;
+    m_channels.back().port = s.port;
+    m_channels.back().trigger.setConfig(m_trigger);
+    if (m_windowMode == SerialSettings::WindowSweep) {
+        QCPGraph *sweepGraph = ui->m_plot->addGraph();
+        sweepGraph->removeFromLegend();
+        sweepGraph->setPen(graph->pen());
+        sweepGraph->setDataBackend(QCPGraph::dbVector);
+        sweepGraph->setAntialiased(true);
+        sweepGraph->setAdaptiveSampling(true);
+        sweepGraph->setSelectable(false);   // 标点只在当前一轮上进行
+        m_channels.back().sweepGraph = sweepGraph;  // 每帧都有擦除，留在main层整体重绘
+    }
+    columns[s.column] = index;
+
+    ui->m_plot->legend->setVisible(m_channels.size() > 1);
+    ui->m_plot->invalidateLayerBuffers(); // 图例内容已变化
+    m_channelBox->addItem(name);
+    return index;
 }
 
 /**
@@ -168,77 +399,396 @@ void MainWindow::startPlot()
  */
 void MainWindow::clearPlot()
 {
-    ui->m_plot->removeGraph(0);
-    time = 0;
     clearPoints();
+    ui->m_plot->clearGraphs();
+    m_channels.clear();
+    m_channelIndex.clear();
+    m_channelBox->clear();
+    m_triggerLine->setVisible(false);
+    time = 0;
 }
 
 /**
- * @brief 读取串口数据并更新绘图。
+ * @brief 重绘定时器触发时调用：记录错过的帧和缓冲区占用，每个统计周期刷新一次指标，然后取数据重绘。
  */
-void MainWindow::readData()
+void MainWindow::renderFrame()
 {
-    QByteArray d = m_serial->readAll();
+    m_telemetry.frameStarted(m_renderTimer.interval());
+    m_telemetry.observeBuffers(m_channelManager);
+    const bool telemetryChanged = m_telemetry.update(m_channelManager);
+    if (telemetryChanged)
+        updateTelemetry();
+
+    // 没有新数据时也要重绘一次，使叠加层上的指标保持更新
+    if (!readData() && telemetryChanged && m_telemetryOverlay->visible())
+        ui->m_plot->replot();
+}
 
-    data = getData(&d);
+/**
+ * @brief 在状态栏和绘图区叠加层显示最新的运行指标。
+ */
+void MainWindow::updateTelemetry()
+{
+    const QString text = m_telemetry.toString();
+    m_telemetryLabel->setText(text);
+    if (m_telemetryOverlay->visible())
+        m_telemetryOverlay->setText(text);
+}
 
-    // qDebug() << "max: " << max << " min: " << min<< endl;
+/**
+ * @brief 显示或隐藏绘图区上的运行指标。
+ * @param visible 是否显示。
+ */
+void MainWindow::showTelemetryOverlay(bool visible)
+{
+    m_telemetryOverlay->setText(m_telemetry.toString());
+    m_telemetryOverlay->setVisible(visible);
+    ui->m_plot->replot();
+}
 
-    if (data > max) {
-        max = data;
-        ui->lineEdit_maxvalue->setText(QString::number(max, 'f', 2));
+/**
+ * @brief 切换曲线的绘制方式。
+ *
+ * 开启后replot()只在GUI线程记录绘制命令，由工作线程绘制到QImage，绘制完成后再刷新窗口，
+ * 曲线点数很多时鼠标操作和串口数据处理不再被绘制阻塞。
+ * 缓存层（背景、网格、坐标轴、图例和增量绘制的曲线层）仍在GUI线程中更新，只把缓存的图像交给工作线程合成，
+ * 两种优化可以同时使用。
+ * @param enabled 为true时在工作线程中绘制。
+ */
+void MainWindow::setThreadedRendering(bool enabled)
+{
+    ui->m_plot->setPlottingHint(QCP::phThreadedRendering, enabled);
+    m_telemetry.setThreadedRendering(enabled);
+    ui->m_plot->replot();
+}
+
+/**
+ * @brief 切换曲线的绘制后端。
+ *
+ * 开启后曲线由GPU直接绘制到窗口的OpenGL帧缓冲中，不读回内存，缓存层照常使用；
+ * 没有可用的OpenGL时提示并保持软件绘制。
+ * 工作线程绘制开启时优先使用工作线程绘制。
+ * @param enabled 为true时用OpenGL绘制。
+ */
+void MainWindow::setOpenGlRendering(bool enabled)
+{
+    if (!ui->m_plot->setOpenGl(enabled)) {
+        ui->actionOpenGL->setChecked(false);
+        QMessageBox::warning(this, tr("OpenGL"), tr("OpenGL is not available, the plot is painted in software."));
     }
-    if (data < min) {
-        min = data;
-        ui->lineEdit_minvalue->setText(QString::number(min, 'f', 2));
+    ui->m_plot->replot();
+}
+
+/**
+ * @brief 从各串口的采样缓冲区取出自上一帧以来的所有数据，按通道分组后批量加入曲线，重绘一次。
+ *
+ * 由重绘定时器按固定帧率调用，没有新数据时不重绘。
+ * @return 有新数据并已重绘时返回true。
+ */
+bool MainWindow::readData()
+{
+    bool changed = false;
+    for (int port = 0; port < m_channelManager.count(); ++port)
+    {
+        SpscRingBuffer<Sample> *buffer = m_channelManager.buffer(port);
+        if (buffer->size() == 0)
+            continue;
+
+        buffer->drain([this](const Sample &s) { addSample(s); });
+        changed = true;
+    }
+    if (!changed)
+        return false;
+
+    commitFrame();
+
+    const int shownPort = m_shownChannel < static_cast<int>(m_channels.size())
+            ? m_channels[m_shownChannel].port : -1;
+    if (shownPort >= 0 && shownPort < m_channelManager.count()) {
+        const SerialReader *reader = m_channelManager.reader(shownPort);
+        const TimingStats stats = reader->timingStats();
+        if (stats.count > 0) {
+            QString message = tr("采样间隔 %1 ms，抖动 %2 ms（%3 ~ %4 ms）")
+                    .arg(stats.meanPeriod * 1000, 0, 'f', 2)
+                    .arg(stats.jitter * 1000, 0, 'f', 2)
+                    .arg(stats.minPeriod * 1000, 0, 'f', 2)
+                    .arg(stats.maxPeriod * 1000, 0, 'f', 2);
+            if (reader->crcErrors() > 0 || reader->resyncs() > 0)
+                message += tr("，CRC错误 %1，重新同步 %2").arg(reader->crcErrors()).arg(reader->resyncs());
+            const TriggerEngine &trigger = m_channels[m_shownChannel].trigger;
+            if (trigger.enabled())
+                message += trigger.state() == TriggerEngine::Captured && trigger.config().single
+                        ? tr("，已触发（%1 s），等待重新触发").arg(trigger.triggerTime(), 0, 'f', 3)
+                        : tr("，已触发 %1 次").arg(trigger.captureCount());
+            ui->statusbar->showMessage(message);
+        }
     }
-    ui->lineEdit_current->setText(QString::number(data, 'f', 2));
 
-    ui->m_plot->graph(0)->addData(time, data);
+    updateTimeAxis();
 
     ui->m_plot->replot();
+    return true;
+}
+
+/**
+ * @brief 把采样点计入所属通道的最值、分析器和触发器，并暂存到本帧数据中。
+ * @param s 采样点。
+ */
+void MainWindow::addSample(const Sample &s)
+{
+    const int c = channelFor(s);
+    if (c < 0)
+        return;
+    PlotChannel &channel = m_channels[c];
+    if (s.value > channel.max)
+        channel.max = s.value;
+    if (s.value < channel.min)
+        channel.min = s.value;
+    channel.current = s.value;
+    time = qMax(time, s.time);
+
+    if (m_windowMode == SerialSettings::WindowSweep) {
+        const qint64 sweep = sweepOf(s.time);
+        if (sweep != channel.sweep)
+            wrapSweep(channel, sweep);
+        channel.frameKeys.append(s.time - sweep * m_windowSize);
+    } else {
+        channel.frameKeys.append(s.time);
+    }
+    channel.frameValues.append(s.value);
+    if (!channel.trigger.enabled())
+        channel.analyzer.addSample(s.time, s.value);
+    else if (channel.trigger.addSample(s))
+        analyzeCapture(c);
+}
 
-    QThread::msleep(10);
-    QApplication::processEvents();
+/**
+ * @brief 把本帧暂存的数据一次性加入各通道曲线，按窗口裁剪后刷新数值显示。
+ */
+void MainWindow::commitFrame()
+{
+    for (PlotChannel &channel : m_channels)
+        flushFrame(channel);
+
+    // 所有通道都加入数据后再按最新时刻统一裁剪
+    for (PlotChannel &channel : m_channels)
+        trimToWindow(channel);
 
-    if (time > TIME_BASE)
+    updateChannelInfo();
+}
+
+/**
+ * @brief 按滚动窗口设置丢弃旧数据，使内存占用保持不变。
+ *
+ * 数据存放在QCPDataVector中，删除头部数据只移动起始下标，均摊O(1)。
+ * 按秒数滚动时点数事先未知，窗口第一次填满时按当前点数的两倍预留，之后的压缩都在这块内存内完成。
+ * 扫描模式下擦除光标右侧一段上一轮的数据，形成擦除间隙。
+ * 显示全部历史或按秒数滚动时，点数超过PLOT_MAX_POINTS即抽稀，长时间采集或回放大文件时内存有上限。
+ * @param channel 通道。
+ */
+void MainWindow::trimToWindow(PlotChannel &channel)
+{
+    QCPDataVector *dataVector = channel.graph->dataVector();
+    switch (m_windowMode)
     {
-        ui->m_plot->xAxis->setRange(0, time);
+    case SerialSettings::WindowSeconds:
+        if (dataVector->firstIndex() == 0 && !dataVector->isEmpty() && dataVector->firstKey() < time - m_windowSize)
+            dataVector->reserve(2 * dataVector->size());
+        channel.graph->removeDataBefore(time - m_windowSize);
+        break;
+    case SerialSettings::WindowSamples:
+        dataVector->removeFirst(dataVector->size() - static_cast<int>(m_windowSize));
+        break;
+    case SerialSettings::WindowSweep:
+    {
+        const double cursor = dataVector->isEmpty() ? 0 : dataVector->lastKey();
+        channel.sweepGraph->removeDataBefore(cursor + m_windowSize * SWEEP_GAP);
+        break;
+    }
+    default:
+        break;
     }
-    time += 0.1;
+    if (m_windowMode != SerialSettings::WindowSamples && m_windowMode != SerialSettings::WindowSweep
+            && dataVector->size() > PLOT_MAX_POINTS)
+        decimate(dataVector);
 }
 
 /**
- * @brief 析构函数，释放UI资源。
+ * @brief 把曲线点数抽稀为一半：每4个点只保留其中的最小值和最大值（按时间先后），波形包络不变。
+ *
+ * 抽稀后要再追加约PLOT_MAX_POINTS/2个点才会再次抽稀，均摊到每个点为O(1)；越早的数据分辨率越低。
+ * @param dataVector 曲线数据。
  */
-MainWindow::~MainWindow()
+void MainWindow::decimate(QCPDataVector *dataVector)
 {
-    delete ui;
+    const int n = dataVector->size();
+    const double *keys = dataVector->keys();
+    const double *values = dataVector->values();
+    QVector<double> newKeys, newValues;
+    newKeys.reserve(n / 2 + 4);
+    newValues.reserve(n / 2 + 4);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int lowest = i, highest = i;
+        for (int j = i + 1; j < i + 4; ++j) {
+            if (values[j] < values[lowest])
+                lowest = j;
+            if (values[j] > values[highest])
+                highest = j;
+        }
+        const int first = std::min(lowest, highest);
+        const int second = std::max(lowest, highest);
+        newKeys.append(keys[first]);
+        newValues.append(values[first]);
+        newKeys.append(keys[second]);
+        newValues.append(values[second]);
+    }
+    for (; i < n; ++i) {
+        newKeys.append(keys[i]);
+        newValues.append(values[i]);
+    }
+    dataVector->assign(newKeys, newValues);
 }
 
 /**
- * @brief 配置按钮点击事件处理函数。
+ * @brief 扫描模式下时刻所属的扫描轮次。
+ * @param t 时刻（秒）。
+ * @return 轮次，第k轮覆盖[k*窗口宽度, (k+1)*窗口宽度)。
  */
-void MainWindow::on_btnConfig_clicked()
+qint64 MainWindow::sweepOf(double t) const
 {
-    settingsDialog.exec();
+    return static_cast<qint64>(std::floor(t / m_windowSize));
+}
+
+/**
+ * @brief 扫描到达右端，开始新一轮扫描。
+ *
+ * 本轮数据整体移交给sweepGraph：交换两条曲线的数据数组，不复制也不重新分配，
+ * graph清空后从左端重新开始。两条曲线的内存在各轮之间重复使用，每帧开销与运行时长无关。
+ * @param channel 通道。
+ * @param sweep 新的扫描轮次。
+ */
+void MainWindow::wrapSweep(PlotChannel &channel, qint64 sweep)
+{
+    flushFrame(channel);    // 本帧中属于上一轮的数据
+    QCPDataVector *current = channel.graph->dataVector();
+    QCPDataVector *previous = channel.sweepGraph->dataVector();
+    current->swap(*previous);
+    current->clear();
+    if (sweep != channel.sweep + 1)
+        previous->clear();  // 中间有整轮没有数据，上一轮已不在屏幕上
+    channel.sweep = sweep;
+}
+
+/**
+ * @brief 把本帧新增数据一次性加入曲线。
+ * @param channel 通道。
+ */
+void MainWindow::flushFrame(PlotChannel &channel)
+{
+    if (channel.frameKeys.isEmpty())
+        return;
+    channel.graph->addData(channel.frameKeys, channel.frameValues);
+    channel.frameKeys.resize(0);
+    channel.frameValues.resize(0);
+}
+
+/**
+ * @brief 时刻在时间轴上的坐标，扫描模式下为本轮内的偏移。
+ * @param t 时刻（秒）。
+ */
+double MainWindow::plotKey(double t) const
+{
+    return m_windowMode == SerialSettings::WindowSweep ? t - sweepOf(t) * m_windowSize : t;
+}
+
+/**
+ * @brief 一次触发捕获完成：只用捕获的触发前后数据重新计算该通道的稳态值和上升时间，并标出触发时刻。
+ * @param c 通道序号。
+ */
+void MainWindow::analyzeCapture(int c)
+{
+    PlotChannel &channel = m_channels[c];
+    channel.analyzer.reset();
+    for (const Sample &s : channel.trigger.capture())
+        channel.analyzer.addSample(s.time, s.value);
+
+    const double key = plotKey(channel.trigger.triggerTime());
+    m_triggerLine->point1->setCoords(key, 0);
+    m_triggerLine->point2->setCoords(key, 1);
+    m_triggerLine->setVisible(true);
+
+    if (c == m_shownChannel)
+        calculateSteadyStateAndRiseTime();
+}
+
+/**
+ * @brief 丢弃各通道冻结的捕获（单次触发），重新等待触发。
+ */
+void MainWindow::rearmTrigger()
+{
+    for (PlotChannel &channel : m_channels)
+        channel.trigger.rearm();
+    m_triggerLine->setVisible(false);
+    ui->m_plot->replot();
 }
 
 /**
- * @brief 从QByteArray中获取数据。
- * @param data 数据字节数组指针。
- * @return 转换后的数据值。
+ * @brief 更新时间轴范围：显示全部历史时从0开始扩展，滚动窗口时跟随最新数据平移，扫描模式固定不变。
  */
-double MainWindow::getData(QByteArray * data)
+void MainWindow::updateTimeAxis()
 {
-    // qDebug()<< "位数：" << data.size();
-    char buf[6];
-    for (qsizetype i = 0; i < data->size(); ++i)
+    switch (m_windowMode)
+    {
+    case SerialSettings::WindowSweep:
+        ui->m_plot->xAxis->setRange(0, m_windowSize);
+        break;
+    case SerialSettings::WindowSeconds:
+        if (time > m_windowSize)
+            ui->m_plot->xAxis->setRange(time - m_windowSize, time);
+        else
+            ui->m_plot->xAxis->setRange(0, m_windowSize);
+        break;
+    case SerialSettings::WindowSamples:
     {
-        // qDebug()<< i << "：" << data.at(i);
-        buf[i] = data->at(i);
+        // 各通道保留的点数相同但速率可能不同，以最早的数据为起点
+        double firstKey = time;
+        for (const PlotChannel &channel : m_channels)
+            if (!channel.graph->dataVector()->isEmpty())
+                firstKey = qMin(firstKey, channel.graph->dataVector()->firstKey());
+        if (time - firstKey > TIME_BASE)
+            ui->m_plot->xAxis->setRange(firstKey, time);
+        else
+            ui->m_plot->xAxis->setRange(firstKey, firstKey + TIME_BASE);
+        break;
+    }
+    default:
+        if (time > TIME_BASE)
+        {
+            ui->m_plot->xAxis->setRange(0, time);
+        }
+        break;
     }
-    return atof(buf);
+}
+
+/**
+ * @brief 析构函数，停止录制和采集线程并释放UI资源。
+ */
+MainWindow::~MainWindow()
+{
+    m_renderTimer.stop();
+    m_channelManager.setRecording(false);
+    m_recorderThread.quit();    // 写盘类析构时写完剩余数据
+    m_recorderThread.wait();
+    delete ui;
+}
+
+/**
+ * @brief 配置按钮点击事件处理函数。
+ */
+void MainWindow::on_btnConfig_clicked()
+{
+    settingsDialog.exec();
 }
 
 /**
@@ -249,10 +799,6 @@ void MainWindow::on_btnReplot_clicked()
     closeSerialPort();
     clearPlot();
     openSerialPort();
-    startPlot();
-
-    max = Y_MIN;
-    min = Y_MAX;
 }
 
 /**
@@ -261,8 +807,8 @@ void MainWindow::on_btnReplot_clicked()
 void MainWindow::clearPoints()
 {
     for (int i = 0; i < tracers.size(); ++i) {
-        tracers[i]->deleteLater();
-        textTips[i]->deleteLater();
+        delete tracers[i];      // 标记点引用了曲线，须在删除曲线之前立即删除
+        delete textTips[i];
     }
     tracers.clear();
     textTips.clear();
@@ -2,20 +2,52 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QSerialPort>
+#include <QThread>
+#include <QTimer>
 
 #include "settingsdialog.h"
 #include "qcustomplot.h"
+#include "ringbuffer.h"
+#include "sample.h"
+#include "serialreader.h"
+#include "channelmanager.h"
+#include "riseanalyzer.h"
+#include "recording.h"
+#include "telemetry.h"
+#include "trigger.h"
 
 #define TIME_BASE  10       // 初始时间轴量程
 #define CLINK_DISTANCE  10  // 标点距离判定
 #define Y_MAX 40            // 纵轴最大值
 #define Y_MIN 20            // 纵轴最小值
 
+#define RENDER_FPS 30               // 默认重绘帧率（Hz）
+#define SWEEP_GAP 0.05              // 扫描模式擦除间隙（占窗口宽度的比例）
+#define PLOT_MAX_POINTS 4000000     // 不按点数滚动时每条曲线保留的最多点数，超出后按最值抽稀
+#define REPLAY_BLOCK 65536          // 回放时两次检查处理时间之间的采样点数
+
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
+class QComboBox;
+class QLabel;
 QT_END_NAMESPACE
 
+/* 单个通道的曲线与统计状态 */
+struct PlotChannel
+{
+    QCPGraph        *graph = nullptr;
+    QCPGraph        *sweepGraph = nullptr;  // 扫描模式：上一轮扫描中尚未被覆盖的部分
+    qint64          sweep = 0;      // 扫描模式：graph中数据所属的扫描轮次
+    int             port = 0;       // 来源串口序号
+    RiseAnalyzer    analyzer;       // 稳态值与上升时间（逐点更新；设置触发时只分析捕获的数据）
+    TriggerEngine   trigger;        // 触发捕获，未设置触发条件时不工作
+    double          max = Y_MIN;    // 最大值
+    double          min = Y_MAX;    // 最小值
+    double          current = 0;    // 当前值
+    QVector<double> frameKeys;      // 本帧新增数据的时间
+    QVector<double> frameValues;    // 本帧新增数据的数值
+};
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -24,6 +56,9 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    void setRenderRate(int fps);    // 设置重绘帧率
+    int renderRate() const { return m_renderRate; }
+
 private slots:
     /* 槽函数 */
     void on_btnConfig_clicked();    // 串口配置按钮
@@ -34,18 +69,58 @@ private slots:
 
     void on_btnPause_clicked();     // 暂停按钮
 
+    void renderFrame();             // 重绘定时器触发：统计运行指标后读取数据并重绘
+    bool readData();                // 从缓冲区读取数据并重绘（每帧一次），没有新数据时返回false
+
+    void toggleRecording(bool checked); // 开始/停止录制
+    void showChannel(int i);        // 切换显示统计量的通道
+    void showTelemetryOverlay(bool visible);    // 显示/隐藏绘图区上的运行指标
+    void openRecording();           // 打开录制文件回放
+    void replayFrame();             // 回放定时器触发：处理一段录制数据并重绘
+    void rearmTrigger();            // 丢弃冻结的捕获，重新等待触发
+    void setThreadedRendering(bool enabled);    // 切换是否在工作线程中绘制曲线
+    void setOpenGlRendering(bool enabled);      // 切换是否用OpenGL绘制曲线
+
 private:
     Ui::MainWindow      *ui;            // 主窗体类
     SettingsDialog      settingsDialog; // 设置窗口类
-    QSerialPort         *m_serial;      // 串口类
 
-    double data;        // 存储当前数据
+    /* 串口采集：每个串口一个通道，解码在工作线程中完成 */
+    ChannelManager      m_channelManager;
 
-    double time = 0;    // 记录当前时间
+    /* 录制：读取线程额外写入录制缓冲区，写盘线程负责落盘 */
+    QThread             m_recorderThread;   // 写盘线程
+    RecordingWriter     *m_recorder;        // 录制写入类，运行于写盘线程
+    RecordingFile       m_recording;        // 正在回放的录制文件，回放期间保持映射
+    QTimer              m_replayTimer;      // 回放定时器，与重绘同频
+    qint64              m_replayPos = 0;    // 下一个回放的采样点
+    QString             m_replayName;       // 回放的文件名和串口名，用于状态栏
 
-    /* 全局最值 */
-    double max;
-    double min;
+    /* 帧率控制：两帧之间到达的数据合并为一次addData和一次replot */
+    QTimer              m_renderTimer;      // 重绘定时器
+    int                 m_renderRate = RENDER_FPS;
+
+    /* 运行指标：状态栏常驻显示，可叠加在绘图区左上角 */
+    Telemetry           m_telemetry;
+    QLabel              *m_telemetryLabel;
+    QCPItemText         *m_telemetryOverlay;
+
+    /* 触发捕获：开始绘图时从设置中读取，每个通道独立判定 */
+    TriggerConfig       m_trigger;
+    QCPItemStraightLine *m_triggerLine;     // 最近一次触发的时刻
+
+    double time = 0;    // 记录当前时间（所有通道中最新的）
+
+    /* 滚动窗口：开始绘图时从设置中读取 */
+    SerialSettings::WindowMode m_windowMode = SerialSettings::WindowAll;
+    double m_windowSize = 0;    // 秒数或点数（扫描模式为扫描宽度秒数）
+
+    /* 各通道的曲线与统计：每个串口的每一列一个通道，收到数据时按需建立 */
+    std::vector<PlotChannel> m_channels;
+    std::vector<std::vector<int>> m_channelIndex;   // [串口][列] -> m_channels下标，-1表示尚未建立
+    QStringList         m_portNames;    // 各串口名称
+    QComboBox           *m_channelBox;  // 选择显示统计量的通道
+    int                 m_shownChannel = 0;
 
     /* 用于曲线标点 */
     QList<QCPItemTracer*> tracers;  // 点集
@@ -55,18 +130,29 @@ private:
     void openSerialPort();  // 开启串口接收
     void closeSerialPort(); // 关闭串口接收
     
-    void startPlot();       // 开始画图
+    void startPlot(const QStringList &names);   // 开始画图，names为各串口名称
+    int channelFor(const Sample &s);            // 采样点所属通道，不存在时建立曲线
+    void addSample(const Sample &s);            // 把采样点计入通道统计和本帧数据
+    void commitFrame();                         // 把本帧数据加入曲线并按窗口裁剪
+    void stopReplay();                          // 停止回放并解除录制文件映射
     void clearPlot();       // 清除曲线
-
-    void readData();                // 读取数据
-    double getData(QByteArray *);   // 处理数据
+    void trimToWindow(PlotChannel &channel);    // 丢弃滚动窗口以外的数据
+    void decimate(QCPDataVector *dataVector);   // 按最值把曲线点数抽稀为一半
+    qint64 sweepOf(double t) const; // 扫描模式下时刻t所属的扫描轮次
+    void wrapSweep(PlotChannel &channel, qint64 sweep); // 开始新一轮扫描
+    void flushFrame(PlotChannel &channel);  // 把本帧新增数据加入曲线
+    double plotKey(double t) const;         // 时刻t在时间轴上的坐标
+    void analyzeCapture(int c);             // 用触发捕获的数据分析通道c
+    void updateTimeAxis();          // 更新时间轴范围
+    void updateChannelInfo();       // 刷新所选通道的数值显示
+    void updateTelemetry();         // 刷新运行指标显示
 
     /* 曲线标点 */
     void appendPoint(QCPGraph *, double, double);   // 增加点
     void removePoint(int i);                        // 删除点
     void clearPoints();                             // 清空所有点
 
-    void calculateSteadyStateAndRiseTime(); // 计算稳态值与上升时间
+    void calculateSteadyStateAndRiseTime(); // 显示所选通道的稳态值与上升时间
 
     void outputPlotData();  // 输出曲线数据（调试用）
 };
@@ -0,0 +1,170 @@
+#include "packetdecoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+/* CRC16-CCITT查找表，启动时生成一次 */
+struct Crc16Table
+{
+    std::uint16_t entries[256];
+
+    Crc16Table()
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            std::uint16_t crc = static_cast<std::uint16_t>(i << 8);
+            for (int bit = 0; bit < 8; ++bit)
+                crc = static_cast<std::uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1);
+            entries[i] = crc;
+        }
+    }
+};
+
+const Crc16Table crcTable;
+
+inline std::uint16_t readUint16(const std::uint8_t *p)
+{
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline std::uint32_t readUint32(const std::uint8_t *p)
+{
+    return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8)
+            | (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+} // namespace
+
+/**
+ * @brief 构造函数。
+ */
+PacketDecoder::PacketDecoder()
+    : m_length(0), m_skipping(false), m_errors(0), m_crcErrors(0), m_resyncs(0)
+{
+}
+
+/**
+ * @brief 计算CRC16-CCITT（多项式0x1021，初值0xFFFF，不反转）。
+ * @param data 数据起始地址。
+ * @param size 字节数。
+ */
+std::uint16_t PacketDecoder::crc16(const std::uint8_t *data, std::size_t size)
+{
+    std::uint16_t crc = 0xFFFF;
+    for (std::size_t i = 0; i < size; ++i)
+        crc = static_cast<std::uint16_t>((crc << 8) ^ crcTable.entries[((crc >> 8) ^ data[i]) & 0xFF]);
+    return crc;
+}
+
+/**
+ * @brief 输入一段字节流并解析其中所有完整的数据包。
+ * @param data 字节流起始地址。
+ * @param size 字节数。
+ * @param out 输出数组，解析出的采样点追加在末尾。
+ * @return 本次解析出的采样点个数。
+ */
+std::size_t PacketDecoder::feed(const char *data, std::size_t size, std::vector<Sample> &out)
+{
+    std::size_t count = 0;
+    while (size > 0)
+    {
+        // 处理后剩余的字节不足一个包，缓冲区总能再放下至少一个包
+        const std::size_t chunk = std::min(size, sizeof(m_buffer) - m_length);
+        std::memcpy(m_buffer + m_length, data, chunk);
+        m_length += chunk;
+        data += chunk;
+        size -= chunk;
+
+        const std::size_t consumed = process(out, count);
+        std::memmove(m_buffer, m_buffer + consumed, m_length - consumed);
+        m_length -= consumed;
+    }
+    return count;
+}
+
+/**
+ * @brief 丢弃未结束的数据包并清零计数。
+ */
+void PacketDecoder::reset()
+{
+    m_length = 0;
+    m_skipping = false;
+    m_errors = 0;
+    m_crcErrors = 0;
+    m_resyncs = 0;
+}
+
+/**
+ * @brief 从缓冲区头部开始解析尽可能多的完整数据包。
+ * @return 已处理（可丢弃）的字节数。
+ */
+std::size_t PacketDecoder::process(std::vector<Sample> &out, std::size_t &count)
+{
+    std::size_t pos = 0;
+    while (m_length - pos >= 2)
+    {
+        const std::uint8_t *p = m_buffer + pos;
+        if (p[0] != PACKET_SYNC0 || p[1] != PACKET_SYNC1)
+        {
+            if (!m_skipping)
+            {
+                m_skipping = true;
+                ++m_resyncs;
+            }
+            ++pos;
+            continue;
+        }
+        m_skipping = false;
+
+        if (m_length - pos < PACKET_HEADER_SIZE)
+            break;
+
+        const std::size_t length = p[2];
+        const std::uint8_t channel = p[3];
+        const std::uint8_t type = p[4];
+        const std::size_t valueSize = type == PayloadInt16 ? 2 : type == PayloadFloat32 ? 4 : 0;
+        if (valueSize == 0 || length == 0 || length % valueSize != 0)
+        {
+            ++m_errors;     // 包头非法，多半是负载中碰巧出现的同步字
+            ++pos;
+            continue;
+        }
+
+        const std::size_t total = PACKET_HEADER_SIZE + length + PACKET_CRC_SIZE;
+        if (m_length - pos < total)
+            break;
+
+        if (crc16(p + 2, PACKET_HEADER_SIZE - 2 + length) != readUint16(p + PACKET_HEADER_SIZE + length))
+        {
+            ++m_crcErrors;
+            ++pos;
+            continue;
+        }
+
+        Sample sample = Sample();
+        sample.time = std::numeric_limits<double>::quiet_NaN();
+        const std::uint8_t *payload = p + PACKET_HEADER_SIZE;
+        for (std::size_t i = 0; i < length; i += valueSize)
+        {
+            if (type == PayloadInt16)
+            {
+                sample.value = static_cast<std::int16_t>(readUint16(payload + i)) * PACKET_INT16_SCALE;
+            }
+            else
+            {
+                const std::uint32_t bits = readUint32(payload + i);
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+                sample.value = value;
+            }
+            sample.column = static_cast<std::uint16_t>(channel + i / valueSize);
+            out.push_back(sample);
+            ++count;
+        }
+        pos += total;
+    }
+    return pos;
+}
@@ -0,0 +1,67 @@
+#ifndef PACKETDECODER_H
+#define PACKETDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sample.h"
+
+/*
+ * 二进制数据包格式（多字节字段均为小端）：
+ *   偏移  长度  内容
+ *   0     2     同步字 0xA5 0x5A
+ *   2     1     负载长度N（字节）
+ *   3     1     通道号（第一个数值的列号）
+ *   4     1     负载类型：0 = int16（乘以PACKET_INT16_SCALE），1 = float32
+ *   5     N     负载：若干个数值，依次属于通道号、通道号+1……
+ *   5+N   2     CRC16-CCITT（多项式0x1021，初值0xFFFF），校验范围为偏移2到5+N-1
+ */
+#define PACKET_SYNC0 0xA5
+#define PACKET_SYNC1 0x5A
+#define PACKET_HEADER_SIZE 5
+#define PACKET_CRC_SIZE 2
+#define PACKET_MAX_PAYLOAD 255
+#define PACKET_MAX_SIZE (PACKET_HEADER_SIZE + PACKET_MAX_PAYLOAD + PACKET_CRC_SIZE)
+#define PACKET_INT16_SCALE 0.01     // int16负载的单位（如0.01℃）
+
+/**
+ * @brief 流式二进制数据包解码器。
+ *
+ * 与SampleDecoder接口相同，在两次调用之间保留未结束的数据包。
+ * 同步字不匹配、包头非法或CRC错误时从下一个字节重新寻找同步字，
+ * 因此负载中出现的同步字或一次损坏最多只丢失一个包。
+ * 解析过程不分配内存，输出采样点的时间为NaN，由调用者打时间戳。
+ */
+class PacketDecoder
+{
+public:
+    enum PayloadType {
+        PayloadInt16 = 0,
+        PayloadFloat32 = 1
+    };
+
+    PacketDecoder();
+
+    /* 输入一段字节流，解析出的采样点追加到out中，返回本次解析出的个数 */
+    std::size_t feed(const char *data, std::size_t size, std::vector<Sample> &out);
+    void reset();   // 丢弃未结束的数据包并清零计数
+
+    std::uint64_t parseErrors() const { return m_errors; }      // 包头非法的次数
+    std::uint64_t crcErrors() const { return m_crcErrors; }     // CRC校验失败的包数
+    std::uint64_t resyncs() const { return m_resyncs; }         // 跳过非同步字节重新同步的次数
+
+    static std::uint16_t crc16(const std::uint8_t *data, std::size_t size);
+
+private:
+    std::size_t process(std::vector<Sample> &out, std::size_t &count);
+
+    std::uint8_t    m_buffer[2 * PACKET_MAX_SIZE];  // 未处理的字节
+    std::size_t     m_length;                       // 未处理的字节数
+    bool            m_skipping;                     // 正在跳过非同步字节
+    std::uint64_t   m_errors;
+    std::uint64_t   m_crcErrors;
+    std::uint64_t   m_resyncs;
+};
+
+#endif // PACKETDECODER_H
@@ -25,6 +25,12 @@
 
 #include "qcustomplot.h"
 
+// SSE2 is part of every x86-64 target, so the kernels need no special compiler flags there:
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(QT_COORD_TYPE) && QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+#  define QCP_SSE2
+#  include <emmintrin.h>
+#endif
+
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -708,6 +714,19 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, double x, double y) const
   
   When a layer is deleted, the objects on it are not deleted with it, but fall on the layer below
   the deleted layer, see QCustomPlot::removeLayer.
+  
+  By default a layer is in \ref lmLogical mode and its layerables are drawn on every replot. Layers
+  whose content rarely changes (e.g. "background", "grid" and "axes" in a streaming plot) can be
+  switched to \ref lmBuffered mode with \ref setMode. Such a layer is rendered into a private image
+  which is only re-rendered when the viewport size, the axis rect geometry or an axis range changed,
+  or when the buffer was invalidated explicitly (\ref invalidateBuffer, \ref
+  QCustomPlot::invalidateLayerBuffers). On all other replots the cached image is just blitted.
+  
+  A layer in \ref lmIncremental mode is cached the same way, but on replots that don't require a
+  full re-render, each layerable may draw what changed since the previous replot on top of the
+  cached image (\ref QCPLayerable::drawIncrement). A graph with the \ref QCPGraph::dbVector
+  backend, for example, only strokes the points appended since the last replot, so streaming data
+  into a plot with constant axis ranges costs about as much as drawing the new segments.
 */
 
 /* start documentation of inline functions */
@@ -741,7 +760,9 @@ QCPLayer::QCPLayer(QCustomPlot *parentPlot, const QString &layerName) :
   mParentPlot(parentPlot),
   mName(layerName),
   mIndex(-1), // will be set to a proper value by the QCustomPlot layer creation function
-  mVisible(true)
+  mVisible(true),
+  mMode(lmLogical),
+  mBufferValid(false)
 {
   // Note: no need to make sure layerName is unique, because layer
   // management is done with QCustomPlot functions.
@@ -772,6 +793,30 @@ QCPLayer::~QCPLayer()
 void QCPLayer::setVisible(bool visible)
 {
   mVisible = visible;
+  mBufferValid = false;
+}
+
+/*!
+  Sets the rendering mode of this layer.
+  
+  In \ref lmBuffered and \ref lmIncremental mode, the layerables are drawn into a cached image
+  which is reused until the plot geometry or an axis range changes. Changes to the appearance of layerables on a buffered
+  layer that don't affect ranges or geometry (e.g. a new axis label or pen) must be followed by
+  \ref invalidateBuffer or \ref QCustomPlot::invalidateLayerBuffers, otherwise the stale cache is
+  shown until the next range change.
+  
+  Exports (\ref QCustomPlot::savePdf, \ref QCustomPlot::toPixmap etc.) always draw all layers
+  directly, regardless of the mode.
+*/
+void QCPLayer::setMode(QCPLayer::LayerMode mode)
+{
+  if (mMode != mode)
+  {
+    mMode = mode;
+    mBufferValid = false;
+    if (mMode == lmLogical)
+      mBuffer = QImage();
+  }
 }
 
 /*! \internal
@@ -792,6 +837,7 @@ void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
       mChildren.prepend(layerable);
     else
       mChildren.append(layerable);
+    mBufferValid = false;
   } else
     qDebug() << Q_FUNC_INFO << "layerable is already child of this layer" << reinterpret_cast<quintptr>(layerable);
 }
@@ -809,6 +855,110 @@ void QCPLayer::removeChild(QCPLayerable *layerable)
 {
   if (!mChildren.removeOne(layerable))
     qDebug() << Q_FUNC_INFO << "layerable is not child of this layer" << reinterpret_cast<quintptr>(layerable);
+  mBufferValid = false;
+}
+
+/*! \internal
+  
+  Draws all visible layerables of this layer with \a painter, each clipped to its clip rect.
+  
+  \see drawBuffered
+*/
+void QCPLayer::drawChildren(QCPPainter *painter)
+{
+  foreach (QCPLayerable *child, mChildren)
+  {
+    if (child->realVisibility())
+    {
+      painter->save();
+      painter->setClipRect(child->clipRect().translated(0, -1));
+      child->applyDefaultAntialiasingHint(painter);
+      child->draw(painter);
+      painter->restore();
+    }
+  }
+}
+
+/*! \internal
+  
+  Lets all visible layerables of this layer draw their changes since the last replot with \a
+  painter (see \ref QCPLayerable::drawIncrement). Returns false as soon as one layerable requires a
+  full re-render.
+  
+  \see drawBuffered
+*/
+bool QCPLayer::drawChildIncrements(QCPPainter *painter)
+{
+  foreach (QCPLayerable *child, mChildren)
+  {
+    if (child->realVisibility())
+    {
+      painter->save();
+      painter->setClipRect(child->clipRect().translated(0, -1));
+      child->applyDefaultAntialiasingHint(painter);
+      bool drawn = child->drawIncrement(painter);
+      painter->restore();
+      if (!drawn)
+        return false;
+    }
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Brings the cached image of this layer up to date. If the cache is invalid or doesn't match the
+  size of the parent plot's paint buffer, the layerables are rendered into a transparent image with
+  the render hints and modes of \a painter. In \ref lmIncremental mode, a valid cache is updated by
+  \ref drawChildIncrements instead. \a painter itself isn't painted on.
+  
+  \see drawBuffered, setMode
+*/
+void QCPLayer::updateBuffer(QCPPainter *painter)
+{
+  const QSize size = mParentPlot->mPaintBuffer.size();
+  if (mBufferValid && mBuffer.size() == size && mMode == lmIncremental)
+  {
+    QCPPainter bufferPainter(&mBuffer);
+    bufferPainter.setRenderHints(painter->renderHints());
+    bufferPainter.setModes(painter->modes());
+    mBufferValid = drawChildIncrements(&bufferPainter);
+  }
+  if (!mBufferValid || mBuffer.size() != size)
+  {
+    if (mBuffer.size() != size)
+    {
+      mBuffer = QImage(size, QImage::Format_ARGB32_Premultiplied);
+      // render text with the resolution of the paint buffer, like layers without a cache:
+      mBuffer.setDotsPerMeterX(qRound(mParentPlot->mPaintBuffer.logicalDpiX()/0.0254));
+      mBuffer.setDotsPerMeterY(qRound(mParentPlot->mPaintBuffer.logicalDpiY()/0.0254));
+    }
+    mBuffer.fill(Qt::transparent);
+    QCPPainter bufferPainter(&mBuffer);
+    bufferPainter.setRenderHints(painter->renderHints());
+    bufferPainter.setModes(painter->modes());
+    drawChildren(&bufferPainter);
+    bufferPainter.end();
+    if (mMode == lmIncremental)
+    {
+      foreach (QCPLayerable *child, mChildren)
+        child->setIncrementBase();
+    }
+    mBufferValid = true;
+  }
+}
+
+/*! \internal
+  
+  Draws this layer via its cached image, which is brought up to date first (see \ref
+  updateBuffer).
+  
+  \see drawChildren, setMode
+*/
+void QCPLayer::drawBuffered(QCPPainter *painter)
+{
+  updateBuffer(painter);
+  painter->drawImage(0, 0, mBuffer);
 }
 
 
@@ -952,6 +1102,8 @@ QCPLayerable::~QCPLayerable()
 */
 void QCPLayerable::setVisible(bool on)
 {
+  if (mVisible != on && mLayer)
+    mLayer->invalidateBuffer();
   mVisible = on;
 }
 
@@ -1196,6 +1348,36 @@ QCP::Interaction QCPLayerable::selectionCategory() const
   return QCP::iSelectOther;
 }
 
+/*! \internal
+  
+  Called instead of \ref draw on replots where the layer of this layerable is in \ref
+  QCPLayer::lmIncremental mode and its cached image is still valid. \a painter paints on top of
+  that image, so a reimplementation only draws what changed since the last call of \ref draw or
+  \ref drawIncrement. If the change can't be expressed as additional drawing (e.g. something was
+  removed), return false and the layer is re-rendered completely.
+  
+  The default implementation draws nothing and returns true, i.e. layerables without incremental
+  support are treated as unchanged, like on a \ref QCPLayer::lmBuffered layer.
+  
+  \see setIncrementBase
+*/
+bool QCPLayerable::drawIncrement(QCPPainter *painter)
+{
+  Q_UNUSED(painter)
+  return true;
+}
+
+/*! \internal
+  
+  Called after the layer of this layerable, which is in \ref QCPLayer::lmIncremental mode, was
+  completely re-rendered into its cached image. Reimplementations record the drawn state here, so
+  the next \ref drawIncrement knows what is already on the image. The default implementation does
+  nothing.
+*/
+void QCPLayerable::setIncrementBase()
+{
+}
+
 /*! \internal
   
   Returns the clipping rectangle of this layerable object. By default, this is the viewport of the
@@ -5370,6 +5552,79 @@ double QCPAxis::coordToPixel(double value) const
   }
 }
 
+/*!
+  Transforms \a count values in coordinates of the axis to pixel coordinates of the QCustomPlot
+  widget, like \ref coordToPixel. The values are read from \a coords and written to \a pixels,
+  advancing by \a coordStride and \a pixelStride doubles per value, so e.g. the key member of a
+  QCPData array can be transformed directly into the x member of a QPointF array.
+  
+  The scale type, orientation and range reversal are evaluated once for the whole array instead of
+  once per value. For linear axes with contiguous arrays, the transformation runs with SSE2 where
+  available. Results may differ from \ref coordToPixel in the last bits due to the different
+  evaluation order.
+  
+  \see linearTransform
+*/
+void QCPAxis::coordsToPixels(const double *coords, double *pixels, int count, int coordStride, int pixelStride) const
+{
+  double scale, offset;
+  if (linearTransform(&scale, &offset))
+  {
+#ifdef QCP_SSE2
+    if (coordStride == 1 && pixelStride == 1)
+    {
+      const __m128d scale2 = _mm_set1_pd(scale);
+      const __m128d offset2 = _mm_set1_pd(offset);
+      int i = 0;
+      for (; i+1<count; i+=2)
+        _mm_storeu_pd(pixels+i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(coords+i), scale2), offset2));
+      if (i < count)
+        pixels[i] = coords[i]*scale+offset;
+      return;
+    }
+#endif
+    for (int i=0; i<count; ++i)
+      pixels[i*pixelStride] = coords[i*coordStride]*scale+offset;
+  } else // mScaleType == stLogarithmic
+  {
+    // pixel = origin + ln(value/reference)*factor, with the branches of coordToPixel resolved here:
+    const double length = orientation() == Qt::Horizontal ? mAxisRect->width() : -mAxisRect->height();
+    const double origin = orientation() == Qt::Horizontal ? mAxisRect->left() : mAxisRect->bottom();
+    const double reference = mRangeReversed ? mRange.upper : mRange.lower;
+    const double factor = (mRangeReversed ? -length : length)/qLn(mRange.upper/mRange.lower);
+    const bool positiveRange = mRange.upper > 0;
+    for (int i=0; i<count; ++i)
+    {
+      const double value = coords[i*coordStride];
+      if (positiveRange ? value <= 0 : value >= 0) // invalid value for logarithmic scale, coordToPixel places it outside visible range
+        pixels[i*pixelStride] = coordToPixel(value);
+      else
+        pixels[i*pixelStride] = origin+qLn(value/reference)*factor;
+    }
+  }
+}
+
+/*!
+  If the axis has a linear scale, sets \a scale and \a offset such that
+  <tt>coordToPixel(value) == value*scale+offset</tt> (up to rounding) and returns true. The
+  coefficients are valid until the range or the axis rect changes.
+  
+  For logarithmic axes, returns false and leaves \a scale and \a offset untouched.
+  
+  \see coordsToPixels
+*/
+bool QCPAxis::linearTransform(double *scale, double *offset) const
+{
+  if (mScaleType != stLinear)
+    return false;
+  double factor = orientation() == Qt::Horizontal ? mAxisRect->width()/mRange.size() : -mAxisRect->height()/mRange.size();
+  if (mRangeReversed)
+    factor = -factor;
+  *scale = factor;
+  *offset = (orientation() == Qt::Horizontal ? mAxisRect->left() : mAxisRect->bottom())-(mRangeReversed ? mRange.upper : mRange.lower)*factor;
+  return true;
+}
+
 /*!
   Returns the part of the axis that is hit by \a pos (in pixels). The return value of this function
   is independent of the user-selectable parts defined with \ref setSelectableParts. Further, this
@@ -8709,6 +8964,216 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
 
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPThreadedRenderer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPThreadedRenderer
+  \brief Rasterizes recorded replots into a double-buffered QImage on a worker thread
+  
+  This class is used internally by QCustomPlot when the plotting hint \ref
+  QCP::phThreadedRendering is set. \ref QCustomPlot::replot then only records the draw calls of
+  the layers in \ref QCPLayer::lmLogical mode into QPictures on the GUI thread. Buffered and
+  incremental layers are brought up to date on the GUI thread as usual, which is cheap while their
+  caches are valid, and contribute their cached images. The frame is passed to \ref render as a
+  list of these parts in layer order. The worker thread plays the parts into the back buffer, swaps
+  it with the front buffer and emits \ref frameRendered. The widget draws the front buffer in its
+  paint event, so the GUI thread never waits for rasterization, which is the dominant cost of
+  line-heavy plots.
+  
+  Only the most recent frame is kept. If \ref render is called again before the worker has
+  picked up the previous frame, the previous one is dropped (see \ref droppedFrames).
+  
+  The recordings are made with \ref QCPPainter::pmNoCaching, so no cached label pixmaps are
+  involved. Since QPixmap must not be used outside the GUI thread, plots rendered this way should
+  not use pixmaps (e.g. \ref QCustomPlot::setBackground(const QPixmap &pm), QCPItemPixmap or
+  pixmap scatter styles). Exports like \ref QCustomPlot::savePng are not affected and always
+  render synchronously.
+*/
+
+/* start of documentation of signals */
+
+/*! \fn void QCPThreadedRenderer::frameRendered(double renderTime)
+  
+  This signal is emitted from the worker thread after a new frame has been swapped into the front
+  buffer. Connections to objects living in the GUI thread are therefore queued.
+  
+  \a renderTime is the time in milliseconds the worker thread spent rasterizing the frame.
+*/
+
+/* end of documentation of signals */
+
+/*!
+  Creates a QCPThreadedRenderer instance and starts its worker thread.
+*/
+QCPThreadedRenderer::QCPThreadedRenderer(QObject *parent) :
+  QThread(parent),
+  mPending(false),
+  mQuit(false),
+  mDroppedFrames(0)
+{
+  start();
+}
+
+/*!
+  Stops the worker thread. A frame that is being rasterized is finished first, a pending recording
+  is discarded.
+*/
+QCPThreadedRenderer::~QCPThreadedRenderer()
+{
+  mMutex.lock();
+  mQuit = true;
+  mCondition.wakeOne();
+  mMutex.unlock();
+  wait();
+}
+
+/*!
+  Returns the most recently rendered frame. The returned image is a shallow copy, so this is cheap
+  and the worker thread may keep rendering while the caller paints it.
+  
+  The image is null until the first frame has been rendered.
+*/
+QImage QCPThreadedRenderer::frontBuffer() const
+{
+  QMutexLocker locker(&mMutex);
+  return mFrontBuffer;
+}
+
+/*!
+  Returns how many recordings were replaced by a newer one before the worker thread got to
+  rasterize them.
+*/
+int QCPThreadedRenderer::droppedFrames() const
+{
+  QMutexLocker locker(&mMutex);
+  return mDroppedFrames;
+}
+
+/*!
+  Queues \a frame to be rasterized into an image of \a size pixels, which is filled with \a
+  fillColor beforehand. The parts of \a frame are painted in order, the first part lowest. The
+  images are shallow copies, so the GUI thread may keep painting into the originals. Returns
+  immediately.
+  
+  If the previous frame is still waiting for the worker thread, it is replaced by \a frame.
+*/
+void QCPThreadedRenderer::render(const QList<FramePart> &frame, const QSize &size, const QColor &fillColor)
+{
+  QMutexLocker locker(&mMutex);
+  if (mPending)
+    ++mDroppedFrames;
+  mPendingFrame = frame;
+  mPendingSize = size;
+  mPendingFillColor = fillColor;
+  mPending = true;
+  mCondition.wakeOne();
+}
+
+/*! \internal
+  
+  The worker loop: waits for a frame, paints its parts into the back buffer and swaps the buffers.
+  The mutex is only held while taking the frame and while swapping, never while painting.
+*/
+void QCPThreadedRenderer::run()
+{
+  forever
+  {
+    mMutex.lock();
+    while (!mPending && !mQuit)
+      mCondition.wait(&mMutex);
+    if (mQuit)
+    {
+      mMutex.unlock();
+      return;
+    }
+    QList<FramePart> frame = mPendingFrame;
+    QSize size = mPendingSize;
+    QColor fillColor = mPendingFillColor;
+    mPendingFrame.clear();
+    mPending = false;
+    mMutex.unlock();
+    
+    if (mBackBuffer.size() != size)
+      mBackBuffer = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    if (mBackBuffer.isNull()) // might happen if QCustomPlot has width or height zero
+      continue;
+    QElapsedTimer timer;
+    timer.start();
+    // play the recordings with the resolution they were recorded at, so fonts keep their size:
+    if (!frame.isEmpty())
+    {
+      mBackBuffer.setDotsPerMeterX(qRound(frame.first().picture.logicalDpiX()/0.0254));
+      mBackBuffer.setDotsPerMeterY(qRound(frame.first().picture.logicalDpiY()/0.0254));
+    }
+    mBackBuffer.fill(fillColor);
+    QPainter painter(&mBackBuffer);
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+    for (int i=0; i<frame.size(); ++i)
+    {
+      if (frame.at(i).image.isNull())
+        painter.drawPicture(0, 0, frame.at(i).picture);
+      else
+        painter.drawImage(0, 0, frame.at(i).image);
+    }
+    painter.end();
+    frame.clear(); // release the layer images, so the GUI thread doesn't need to detach them
+    
+    const double renderTime = timer.nsecsElapsed()*1e-6;
+    
+    mMutex.lock();
+    qSwap(mFrontBuffer, mBackBuffer);
+    mMutex.unlock();
+    emit frameRendered(renderTime);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPOpenGlView
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef QCP_OPENGL_FBO
+/*! \class QCPOpenGlView
+  \brief Child widget that paints a QCustomPlot with OpenGL
+  
+  This class is used internally by QCustomPlot when OpenGL is enabled (see \ref
+  QCustomPlot::setOpenGl). It covers the whole plot widget and is transparent for mouse events, so
+  all interaction is still handled by QCustomPlot.
+  
+  QOpenGLWidget renders into a framebuffer object that Qt composites onto the window on the GPU.
+  \ref paintGL paints the plot straight into it, so unlike painting into a separate framebuffer
+  object, no frame has to be read back into system memory.
+*/
+
+/*!
+  Creates a QCPOpenGlView as child of \a parentPlot. It is created by \ref QCustomPlot::setOpenGl,
+  so there is no need to instantiate this class directly.
+*/
+QCPOpenGlView::QCPOpenGlView(QCustomPlot *parentPlot) :
+  QOpenGLWidget(parentPlot),
+  mParentPlot(parentPlot)
+{
+  setAttribute(Qt::WA_TransparentForMouseEvents);
+}
+
+/*! \internal
+  
+  Paints the parent plot into the framebuffer of this widget, see \ref QCustomPlot::paintOpenGl.
+*/
+void QCPOpenGlView::paintGL()
+{
+  QCPPainter painter;
+  if (!painter.begin(this))
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on OpenGL view";
+    return;
+  }
+  mParentPlot->paintOpenGl(&painter);
+}
+#endif
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCustomPlot
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -8935,6 +9400,16 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
   \see replot, beforeReplot
 */
 
+/*! \fn void QCustomPlot::afterRender(double renderTime)
+  
+  This signal is emitted when the worker thread has finished rasterizing a replot, if the plotting
+  hint \ref QCP::phThreadedRendering is set. In that mode, \ref afterReplot is emitted as soon as
+  the replot is recorded, before it is rasterized. \a renderTime is the time in milliseconds the
+  worker thread spent rasterizing.
+  
+  \see afterReplot
+*/
+
 /* end of documentation of signals */
 /* start of documentation of public members */
 
@@ -9034,7 +9509,14 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mCurrentLayer(0),
   mPlottingHints(QCP::phCacheLabels|QCP::phForceRepaint),
   mMultiSelectModifier(Qt::ControlModifier),
+  mOpenGl(false),
   mPaintBuffer(size()),
+  mThreadedRenderer(0),
+  mOpenGlMultisamples(16),
+#ifdef QCP_OPENGL_FBO
+  mGlView(0),
+#endif
+  mGlPainting(false),
   mMouseEventElement(0),
   mReplotting(false)
 {
@@ -9088,6 +9570,9 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
 
 QCustomPlot::~QCustomPlot()
 {
+  delete mThreadedRenderer; // stops the worker thread before the plot is torn down
+  mThreadedRenderer = 0;
+  freeOpenGl();
   clearPlottables();
   clearItems();
 
@@ -9317,6 +9802,19 @@ void QCustomPlot::setNoAntialiasingOnDrag(bool enabled)
 */
 void QCustomPlot::setPlottingHints(const QCP::PlottingHints &hints)
 {
+  if (hints.testFlag(QCP::phThreadedRendering) != mPlottingHints.testFlag(QCP::phThreadedRendering))
+  {
+    if (hints.testFlag(QCP::phThreadedRendering))
+    {
+      mThreadedRenderer = new QCPThreadedRenderer(this);
+      connect(mThreadedRenderer, SIGNAL(frameRendered(double)), this, SLOT(update()));
+      connect(mThreadedRenderer, SIGNAL(frameRendered(double)), this, SIGNAL(afterRender(double)));
+    } else
+    {
+      delete mThreadedRenderer;
+      mThreadedRenderer = 0;
+    }
+  }
   mPlottingHints = hints;
 }
 
@@ -9352,6 +9850,45 @@ void QCustomPlot::setMultiSelectModifier(Qt::KeyboardModifier modifier)
   mMultiSelectModifier = modifier;
 }
 
+/*!
+  Sets whether the plot is painted with OpenGL instead of into the raster paint buffer. The plot is
+  then painted by an internal QOpenGLWidget that covers the QCustomPlot widget. Line-heavy plots
+  are rasterized by the GPU directly into the framebuffer object that Qt composites onto the
+  window, so no frame is read back into system memory. \a multisampling sets the number of samples
+  per pixel used for antialiasing, it is reduced by the driver if not supported.
+  
+  Layer buffers (see \ref QCPLayer::setMode) stay in use: the cached images of buffered and
+  incremental layers are drawn as textures, which the OpenGL paint engine only uploads again when
+  the image changed. So only the layers without a cache are painted completely on every replot.
+  
+  OpenGL support must be enabled at compile time by defining \c QCUSTOMPLOT_USE_OPENGL (requires
+  Qt 5.4). If no OpenGL context can be created or it doesn't support framebuffer objects, e.g. on
+  machines without GPU driver, OpenGL stays disabled and the raster paint buffer is used as before.
+  On headless machines a software implementation like Mesa's llvmpipe (\c LIBGL_ALWAYS_SOFTWARE=1)
+  can provide the context.
+  
+  While the plotting hint \ref QCP::phThreadedRendering is set, that mode takes precedence and the
+  OpenGL view is hidden.
+  
+  Returns true if the requested state was established.
+*/
+bool QCustomPlot::setOpenGl(bool enabled, int multisampling)
+{
+  mOpenGlMultisamples = qMax(0, multisampling);
+#ifdef QCP_OPENGL_FBO
+  freeOpenGl();
+  mOpenGl = enabled && setupOpenGl();
+  if (enabled && !mOpenGl)
+    freeOpenGl();
+  return mOpenGl == enabled;
+#else
+  if (enabled)
+    qDebug() << Q_FUNC_INFO << "QCustomPlot can't use OpenGL because QCUSTOMPLOT_USE_OPENGL was not defined during compilation (requires Qt 5.4)";
+  mOpenGl = false;
+  return !enabled;
+#endif
+}
+
 /*!
   Sets the viewport of this QCustomPlot. The Viewport is the area that the top level layout
   (QCustomPlot::plotLayout()) uses as its rect. Normally, the viewport is the entire widget rect.
@@ -10183,6 +10720,22 @@ bool QCustomPlot::moveLayer(QCPLayer *layer, QCPLayer *otherLayer, QCustomPlot::
   return true;
 }
 
+/*!
+  Invalidates the cached images of all layers in \ref QCPLayer::lmBuffered or \ref
+  QCPLayer::lmIncremental mode, so they are re-rendered on the next replot.
+  
+  Changes of the viewport size, the axis rect geometry and the axis ranges are detected
+  automatically. Call this function after changing other properties of objects on buffered layers,
+  e.g. axis labels, pens or the legend content.
+  
+  \see QCPLayer::setMode, QCPLayer::invalidateBuffer
+*/
+void QCustomPlot::invalidateLayerBuffers()
+{
+  foreach (QCPLayer *layer, mLayers)
+    layer->invalidateBuffer();
+}
+
 /*!
   Returns the number of axis rects in the plot.
   
@@ -10348,6 +10901,7 @@ void QCustomPlot::deselectAll()
     foreach (QCPLayerable *layerable, layer->children())
       layerable->deselectEvent(0);
   }
+  invalidateLayerBuffers();
 }
 
 /*!
@@ -10362,6 +10916,12 @@ void QCustomPlot::deselectAll()
   afterReplot is emitted. It is safe to mutually connect the replot slot with any of those two
   signals on two QCustomPlots to make them replot synchronously, it won't cause an infinite
   recursion.
+  
+  If the plotting hint \ref QCP::phThreadedRendering is set, the plot is only recorded here and
+  rasterized by a worker thread (see \ref QCPThreadedRenderer). The widget surface is then
+  refreshed when the frame is ready, independent of \a refreshPriority, and \ref afterReplot is
+  emitted before the new frame is visible. Otherwise, if OpenGL is enabled (see \ref setOpenGl),
+  the layout is updated here and the plot is painted by the OpenGL view when it is repainted.
 */
 void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
 {
@@ -10370,6 +10930,36 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   mReplotting = true;
   emit beforeReplot();
   
+#ifdef QCP_OPENGL_FBO
+  if (mGlView)
+    mGlView->setVisible(!mThreadedRenderer);
+#endif
+  if (mThreadedRenderer)
+  {
+    replotThreaded();
+    emit afterReplot();
+    mReplotting = false;
+    return;
+  }
+  
+  const bool immediate = (refreshPriority == rpHint && mPlottingHints.testFlag(QCP::phForceRepaint)) || refreshPriority==rpImmediate;
+#ifdef QCP_OPENGL_FBO
+  if (mGlView)
+  {
+    // run through layout phases now, so coordinate conversions are valid after replot returns:
+    mPlotLayout->update(QCPLayoutElement::upPreparation);
+    mPlotLayout->update(QCPLayoutElement::upMargins);
+    mPlotLayout->update(QCPLayoutElement::upLayout);
+    if (immediate)
+      mGlView->repaint();
+    else
+      mGlView->update();
+    emit afterReplot();
+    mReplotting = false;
+    return;
+  }
+#endif
+  
   mPaintBuffer.fill(mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : Qt::transparent);
   QCPPainter painter;
   painter.begin(&mPaintBuffer);
@@ -10380,7 +10970,7 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
       painter.fillRect(mViewport, mBackgroundBrush);
     draw(&painter);
     painter.end();
-    if ((refreshPriority == rpHint && mPlottingHints.testFlag(QCP::phForceRepaint)) || refreshPriority==rpImmediate)
+    if (immediate)
       repaint();
     else
       update();
@@ -10391,29 +10981,167 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   mReplotting = false;
 }
 
-/*!
-  Rescales the axes such that all plottables (like graphs) in the plot are fully visible.
+/*! \internal
   
-  if \a onlyVisiblePlottables is set to true, only the plottables that have their visibility set to true
-  (QCPLayerable::setVisible), will be used to rescale the axes.
+  Prepares a frame for the worker thread of \ref mThreadedRenderer and hands it over. Called by
+  \ref replot if the plotting hint \ref QCP::phThreadedRendering is set.
   
-  \see QCPAbstractPlottable::rescaleAxes, QCPAxis::rescale
+  Consecutive layers in \ref QCPLayer::lmLogical mode are recorded into one QPicture each. The
+  recordings are made with \ref QCPPainter::pmNoCaching, because the cached label pixmaps may not be
+  used on the worker thread. Layers in \ref QCPLayer::lmBuffered and \ref QCPLayer::lmIncremental
+  mode update their cached images here on the GUI thread, the same way \ref draw does for the
+  raster paint buffer, and the images are passed on between the recordings. So only the layers
+  without a cache are traversed completely on every replot.
 */
-void QCustomPlot::rescaleAxes(bool onlyVisiblePlottables)
+void QCustomPlot::replotThreaded()
 {
-  QList<QCPAxis*> allAxes;
-  foreach (QCPAxisRect *rect, axisRects())
-    allAxes << rect->axes();
+  // run through layout phases:
+  mPlotLayout->update(QCPLayoutElement::upPreparation);
+  mPlotLayout->update(QCPLayoutElement::upMargins);
+  mPlotLayout->update(QCPLayoutElement::upLayout);
+  updateLayerBufferKey();
   
-  foreach (QCPAxis *axis, allAxes)
-    axis->rescale(onlyVisiblePlottables);
-}
-
-/*!
-  Saves a PDF with the vectorized plot to the file \a fileName. The axis ratio as well as the scale
-  of texts and lines will be derived from the specified \a width and \a height. This means, the
-  output will look like the normal on-screen output of a QCustomPlot widget with the corresponding
-  pixel width and height. If either \a width or \a height is zero, the exported image will have the
+  QList<QCPThreadedRenderer::FramePart> frame;
+  QCPThreadedRenderer::FramePart recording;
+  QCPPainter painter;
+  if (!painter.begin(&recording.picture))
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on picture";
+    return;
+  }
+  painter.setMode(QCPPainter::pmNoCaching);
+  painter.setRenderHint(QPainter::HighQualityAntialiasing);
+  if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
+    painter.fillRect(mViewport, mBackgroundBrush);
+  drawBackground(&painter);
+  
+  foreach (QCPLayer *layer, mLayers)
+  {
+    if (layer->mode() == QCPLayer::lmLogical)
+    {
+      layer->drawChildren(&painter);
+      continue;
+    }
+    if (!layer->visible())
+      continue;
+    layer->updateBuffer(&painter);
+    // close the current recording, insert the cached image and start a new recording above it:
+    painter.end();
+    frame.append(recording);
+    QCPThreadedRenderer::FramePart cached;
+    cached.image = layer->mBuffer;
+    frame.append(cached);
+    recording.picture = QPicture();
+    painter.begin(&recording.picture);
+    painter.setMode(QCPPainter::pmNoCaching);
+    painter.setRenderHint(QPainter::HighQualityAntialiasing);
+  }
+  painter.end();
+  frame.append(recording);
+  
+  mThreadedRenderer->render(frame, size(), mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : QColor(Qt::transparent));
+}
+
+/*! \internal
+  
+  Paints the plot with \a painter, which is active on the framebuffer of \ref mGlView. Called by
+  \ref QCPOpenGlView::paintGL. The layout was already updated by \ref replot (or \ref
+  resizeEvent), the layer buffers are used like for the raster paint buffer.
+*/
+void QCustomPlot::paintOpenGl(QCPPainter *painter)
+{
+  painter->setRenderHint(QPainter::HighQualityAntialiasing);
+  painter->setCompositionMode(QPainter::CompositionMode_Source); // framebuffer isn't cleared between replots
+  painter->fillRect(rect(), mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : QColor(Qt::transparent));
+  painter->setCompositionMode(QPainter::CompositionMode_SourceOver);
+  if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
+    painter->fillRect(mViewport, mBackgroundBrush);
+  mGlPainting = true;
+  draw(painter);
+  mGlPainting = false;
+}
+
+/*! \internal
+  
+  Checks that an OpenGL context supporting framebuffer objects can be created, then creates \ref
+  mGlView covering the widget. Returns false if OpenGL isn't available.
+  
+  \see setOpenGl, freeOpenGl
+*/
+bool QCustomPlot::setupOpenGl()
+{
+#ifdef QCP_OPENGL_FBO
+  QOpenGLContext context;
+  if (!context.create())
+  {
+    qDebug() << Q_FUNC_INFO << "Failed to create OpenGL context";
+    return false;
+  }
+  QOffscreenSurface surface;
+  surface.setFormat(context.format());
+  surface.create();
+  if (!surface.isValid() || !context.makeCurrent(&surface))
+  {
+    qDebug() << Q_FUNC_INFO << "Failed to make OpenGL context current on offscreen surface";
+    return false;
+  }
+  const bool fboSupported = QOpenGLFramebufferObject::hasOpenGLFramebufferObjects();
+  context.doneCurrent();
+  if (!fboSupported)
+  {
+    qDebug() << Q_FUNC_INFO << "OpenGL context doesn't support framebuffer objects";
+    return false;
+  }
+  
+  mGlView = new QCPOpenGlView(this);
+  QSurfaceFormat format = mGlView->format();
+  format.setSamples(mOpenGlMultisamples);
+  mGlView->setFormat(format);
+  mGlView->setGeometry(rect());
+  mGlView->setVisible(!mThreadedRenderer);
+  return true;
+#else
+  return false;
+#endif
+}
+
+/*! \internal
+  
+  Deletes \ref mGlView, which releases its context and framebuffer.
+  
+  \see setupOpenGl
+*/
+void QCustomPlot::freeOpenGl()
+{
+#ifdef QCP_OPENGL_FBO
+  delete mGlView;
+  mGlView = 0;
+#endif
+}
+
+/*!
+  Rescales the axes such that all plottables (like graphs) in the plot are fully visible.
+  
+  if \a onlyVisiblePlottables is set to true, only the plottables that have their visibility set to true
+  (QCPLayerable::setVisible), will be used to rescale the axes.
+  
+  \see QCPAbstractPlottable::rescaleAxes, QCPAxis::rescale
+*/
+void QCustomPlot::rescaleAxes(bool onlyVisiblePlottables)
+{
+  QList<QCPAxis*> allAxes;
+  foreach (QCPAxisRect *rect, axisRects())
+    allAxes << rect->axes();
+  
+  foreach (QCPAxis *axis, allAxes)
+    axis->rescale(onlyVisiblePlottables);
+}
+
+/*!
+  Saves a PDF with the vectorized plot to the file \a fileName. The axis ratio as well as the scale
+  of texts and lines will be derived from the specified \a width and \a height. This means, the
+  output will look like the normal on-screen output of a QCustomPlot widget with the corresponding
+  pixel width and height. If either \a width or \a height is zero, the exported image will have the
   same dimensions as the QCustomPlot widget currently has.
 
   \a noCosmeticPen disables the use of cosmetic pens when drawing to the PDF file. Cosmetic pens
@@ -10658,7 +11386,19 @@ void QCustomPlot::paintEvent(QPaintEvent *event)
 {
   Q_UNUSED(event);
   QPainter painter(this);
-  painter.drawPixmap(0, 0, mPaintBuffer);
+  if (mThreadedRenderer)
+  {
+    QImage frame = mThreadedRenderer->frontBuffer();
+    if (frame.width() < width() || frame.height() < height()) // no frame for the current size yet
+      painter.fillRect(rect(), mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : palette().color(QPalette::Window));
+    painter.drawImage(0, 0, frame);
+  }
+#ifdef QCP_OPENGL_FBO
+  else if (mGlView)
+    return; // covered by the OpenGL view
+#endif
+  else
+    painter.drawPixmap(0, 0, mPaintBuffer);
 }
 
 /*! \internal
@@ -10672,6 +11412,10 @@ void QCustomPlot::resizeEvent(QResizeEvent *event)
   // resize and repaint the buffer:
   mPaintBuffer = QPixmap(event->size());
   setViewport(rect());
+#ifdef QCP_OPENGL_FBO
+  if (mGlView)
+    mGlView->setGeometry(rect());
+#endif
   replot(rpQueued); // queued update is important here, to prevent painting issues in some contexts
 }
 
@@ -10813,6 +11557,7 @@ void QCustomPlot::mouseReleaseEvent(QMouseEvent *event)
       if (selectionStateChanged)
       {
         doReplot = true;
+        invalidateLayerBuffers(); // selected axes and legends are drawn differently
         emit selectionChangedByUser();
       }
     }
@@ -10881,20 +11626,20 @@ void QCustomPlot::draw(QCPPainter *painter)
   // draw viewport background pixmap:
   drawBackground(painter);
 
+  // buffered layers are only used for the on-screen paint buffer or OpenGL view, exports always draw directly:
+  const bool useLayerBuffers = painter->device() == &mPaintBuffer || mGlPainting;
+  if (useLayerBuffers)
+    updateLayerBufferKey();
+  
   // draw all layered objects (grid, axes, plottables, items, legend,...):
   foreach (QCPLayer *layer, mLayers)
   {
-    foreach (QCPLayerable *child, layer->children())
+    if (useLayerBuffers && layer->mode() != QCPLayer::lmLogical)
     {
-      if (child->realVisibility())
-      {
-        painter->save();
-        painter->setClipRect(child->clipRect().translated(0, -1));
-        child->applyDefaultAntialiasingHint(painter);
-        child->draw(painter);
-        painter->restore();
-      }
-    }
+      if (layer->visible())
+        layer->drawBuffered(painter);
+    } else
+      layer->drawChildren(painter);
   }
   
   /* Debug code to draw all layout element rects
@@ -10909,6 +11654,44 @@ void QCustomPlot::draw(QCPPainter *painter)
   */
 }
 
+/*! \internal
+  
+  Compares \ref layerBufferKey with the key of the previous replot and invalidates all layer
+  buffers if it differs.
+*/
+void QCustomPlot::updateLayerBufferKey()
+{
+  QVector<double> key = layerBufferKey();
+  if (key != mLayerBufferKey)
+  {
+    mLayerBufferKey = key;
+    invalidateLayerBuffers();
+  }
+}
+
+/*! \internal
+  
+  Returns a key describing everything the content of buffered layers typically depends on: the
+  size of the paint buffer, the geometry of all axis rects and the ranges of all their axes. \ref
+  updateLayerBufferKey compares it with the key of the previous replot and invalidates all layer
+  buffers when it differs.
+  
+  \see QCPLayer::setMode
+*/
+QVector<double> QCustomPlot::layerBufferKey() const
+{
+  QVector<double> key;
+  key << mPaintBuffer.width() << mPaintBuffer.height();
+  foreach (QCPAxisRect *rect, axisRects())
+  {
+    const QRect r = rect->rect();
+    key << r.left() << r.top() << r.width() << r.height();
+    foreach (QCPAxis *axis, rect->axes())
+      key << axis->range().lower << axis->range().upper;
+  }
+  return key;
+}
+
 /*! \internal
   
   Draws the viewport background pixmap of the plot.
@@ -14416,6 +15199,607 @@ QCPData::QCPData(double key, double value) :
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPDataVector
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPDataVector
+  \brief Contiguous, key-sorted storage of graph data points.
+  
+  Keys and values are held in two separate arrays (structure of arrays), so a data point costs 16
+  bytes instead of a \ref QCPDataMap node, appending a key that is not smaller than the current last
+  key is amortized O(1), lookups by key are binary searches and scans over the data are linear
+  memory accesses. Keys that arrive out of order are still inserted at their sorted position, but
+  this costs O(n).
+  
+  Removing data from the front (\ref removeBefore, \ref removeFirst) only advances a start offset.
+  The arrays are compacted once the unused front part exceeds the used part, so removal is
+  amortized O(1) per point as well.
+  
+  For fast drawing of very long data sets, \ref valueBounds returns the minimum and maximum value of
+  any index range in O(log n). It uses a min/max decimation pyramid, which is built the first time
+  it is needed and afterwards updated incrementally as points are added or removed from the front.
+  Short ranges, the ragged ends of long ranges and the lowest pyramid level are reduced directly
+  from the value array with \ref reduceValues, which processes blocks of values with SIMD.
+  Other modifications (out of order insertion, removal in the middle or at the end) discard the
+  pyramid, it is then rebuilt on next use.
+  
+  Error bars are not stored. This is the container used by QCPGraph when its data backend is set to
+  \ref QCPGraph::dbVector.
+  
+  \see QCPGraph::setDataBackend, QCPGraph::dataVector
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn const double *QCPDataVector::keys() const
+  
+  Returns a pointer to the first of \ref size consecutive keys. The pointer is invalidated by any
+  non-const method.
+*/
+
+/*! \fn const double *QCPDataVector::values() const
+  
+  Returns a pointer to the first of \ref size consecutive values, belonging to the keys returned by
+  \ref keys. The pointer is invalidated by any non-const method.
+*/
+
+/*! \fn qint64 QCPDataVector::firstIndex() const
+  
+  Returns the running index of the first stored data point, i.e. the number of points that were
+  removed from the front (\ref removeBefore, \ref removeFirst) since the last \ref clear. Together
+  with \ref size, it identifies data points across appends and front removals.
+*/
+
+/*! \fn int QCPDataVector::revision() const
+  
+  Returns a counter that changes with every modification other than appending at the end and
+  removing from the front. If it is unchanged, all points that were stored earlier and are still
+  stored kept their running index (see \ref firstIndex), key and value.
+*/
+
+/* end of documentation of inline functions */
+
+/*!
+  Constructs an empty data vector.
+*/
+QCPDataVector::QCPDataVector() :
+  mBegin(0),
+  mFirstIndex(0),
+  mRevision(0),
+  mPyramidValid(false)
+{
+}
+
+/*!
+  Reserves space for \a size data points, so appending up to that many points doesn't reallocate.
+*/
+void QCPDataVector::reserve(int size)
+{
+  compact();
+  mKeys.reserve(size);
+  mValues.reserve(size);
+}
+
+/*!
+  Removes all data points. The allocated memory is kept for reuse (as far as QVector::clear keeps
+  it, i.e. since Qt 5.7).
+*/
+void QCPDataVector::clear()
+{
+  mKeys.clear();
+  mValues.clear();
+  mBegin = 0;
+  mFirstIndex = 0;
+  invalidatePyramid();
+}
+
+/*!
+  Exchanges the data points, the decimation pyramid and the allocated memory of this data vector
+  with those of \a other in constant time. The \ref revision of both is advanced.
+*/
+void QCPDataVector::swap(QCPDataVector &other)
+{
+  mKeys.swap(other.mKeys);
+  mValues.swap(other.mValues);
+  qSwap(mBegin, other.mBegin);
+  qSwap(mFirstIndex, other.mFirstIndex);
+  mLevels.swap(other.mLevels);
+  mLevelFirst.swap(other.mLevelFirst);
+  qSwap(mPyramidValid, other.mPyramidValid);
+  ++mRevision;
+  ++other.mRevision;
+}
+
+/*!
+  Adds the data point \a key, \a value. If \a key is not smaller than \ref lastKey, the point is
+  appended in amortized constant time, otherwise it is inserted at its sorted position.
+*/
+void QCPDataVector::add(double key, double value)
+{
+  if (isEmpty() || key >= mKeys.last())
+  {
+    mKeys.append(key);
+    mValues.append(value);
+    if (mPyramidValid)
+      updatePyramid(value);
+  } else
+    insert(key, value);
+}
+
+/*! \overload
+  
+  Adds the data points given as \a keys and \a values pairs.
+*/
+void QCPDataVector::add(const QVector<double> &keys, const QVector<double> &values)
+{
+  int n = qMin(keys.size(), values.size());
+  mKeys.reserve(mKeys.size()+n);
+  mValues.reserve(mValues.size()+n);
+  for (int i=0; i<n; ++i)
+    add(keys.at(i), values.at(i));
+}
+
+/*!
+  Replaces the current data with the \a keys and \a values pairs.
+*/
+void QCPDataVector::assign(const QVector<double> &keys, const QVector<double> &values)
+{
+  clear();
+  add(keys, values);
+}
+
+/*! \overload
+  
+  Replaces the current data with the keys and values of \a dataMap. Error bars are dropped.
+*/
+void QCPDataVector::assign(const QCPDataMap &dataMap)
+{
+  clear();
+  mKeys.reserve(dataMap.size());
+  mValues.reserve(dataMap.size());
+  QCPDataMap::const_iterator it;
+  for (it = dataMap.constBegin(); it != dataMap.constEnd(); ++it)
+  {
+    mKeys.append(it.key());
+    mValues.append(it.value().value);
+  }
+}
+
+/*!
+  Returns the index of the first data point with a key not smaller than \a key, or \ref size if
+  there is none.
+*/
+int QCPDataVector::lowerBound(double key) const
+{
+  return std::lower_bound(mKeys.constBegin()+mBegin, mKeys.constEnd(), key)-(mKeys.constBegin()+mBegin);
+}
+
+/*!
+  Returns the index of the first data point with a key greater than \a key, or \ref size if there
+  is none.
+*/
+int QCPDataVector::upperBound(double key) const
+{
+  return std::upper_bound(mKeys.constBegin()+mBegin, mKeys.constEnd(), key)-(mKeys.constBegin()+mBegin);
+}
+
+/*!
+  Removes all data points with keys smaller than \a key.
+*/
+void QCPDataVector::removeBefore(double key)
+{
+  removeFirst(lowerBound(key));
+}
+
+/*!
+  Removes all data points with keys greater than \a key.
+*/
+void QCPDataVector::removeAfter(double key)
+{
+  int index = mBegin+upperBound(key);
+  if (index == mKeys.size()) return;
+  mKeys.resize(index);
+  mValues.resize(index);
+  invalidatePyramid();
+}
+
+/*!
+  Removes all data points with keys greater than \a fromKey and smaller or equal to \a toKey, the
+  same interval as \ref QCPGraph::removeData(double fromKey, double toKey) uses.
+*/
+void QCPDataVector::remove(double fromKey, double toKey)
+{
+  if (fromKey >= toKey || isEmpty()) return;
+  erase(upperBound(fromKey), upperBound(toKey));
+}
+
+/*! \overload
+  
+  Removes all data points with a key equal to \a key.
+*/
+void QCPDataVector::remove(double key)
+{
+  erase(lowerBound(key), upperBound(key));
+}
+
+/*!
+  Removes the first \a count data points.
+*/
+void QCPDataVector::removeFirst(int count)
+{
+  count = qBound(0, count, size());
+  if (count == 0) return;
+  mBegin += count;
+  mFirstIndex += count;
+  if (isEmpty())
+    clear();
+  else
+  {
+    if (mBegin > size())
+      compact();
+    if (mPyramidValid)
+      trimPyramid();
+  }
+}
+
+/*!
+  Determines the smallest and largest value of the data points with indices in the range [\a from,
+  \a to), ignoring NaN values. If \a mean is non-zero, it is set to the mean of these values.
+  
+  Apart from the first call, which builds the decimation pyramid in O(n), this takes O(log n) time
+  regardless of the size of the range, so it can be used to decimate arbitrarily long data to a
+  few points per pixel.
+  
+  Returns false if the range contains no valid values, in which case the output parameters are
+  left unchanged.
+  
+  \see reduceValues
+*/
+bool QCPDataVector::valueBounds(int from, int to, double &minValue, double &maxValue, double *mean) const
+{
+  from = qMax(from, 0);
+  to = qMin(to, size());
+  if (from >= to) return false;
+  
+  PyramidBin result;
+  result.min = std::numeric_limits<double>::max();
+  result.max = -std::numeric_limits<double>::max();
+  result.sum = 0;
+  result.count = 0;
+  const double *data = mValues.constData()+mBegin;
+  qint64 a = mFirstIndex+from;
+  qint64 b = mFirstIndex+to;
+  
+  // short ranges are reduced directly, that's faster than walking the pyramid and doesn't need it built:
+  if (b-a <= pyramidFanout*pyramidFanout)
+  {
+    accumulate(result, data+from, to-from);
+    a = b;
+  } else if (!mPyramidValid)
+    buildPyramid();
+  
+  // ragged ends on data point level, until both ends are aligned to bins of level 0:
+  if (mLevels.isEmpty())
+  {
+    accumulate(result, data+(a-mFirstIndex), b-a);
+    a = b;
+  }
+  const qint64 headEnd = qMin(b, (a+pyramidFanout-1)/pyramidFanout*pyramidFanout);
+  accumulate(result, data+(a-mFirstIndex), headEnd-a);
+  a = headEnd;
+  const qint64 tailBegin = qMax(a, b/pyramidFanout*pyramidFanout);
+  accumulate(result, data+(tailBegin-mFirstIndex), b-tailBegin);
+  b = tailBegin;
+  // walk up the levels, each level contributes at most 2*(pyramidFanout-1) bins:
+  for (int level=0; level<mLevels.size() && a < b; ++level)
+  {
+    a /= pyramidFanout;
+    b /= pyramidFanout;
+    const QVector<PyramidBin> &bins = mLevels.at(level);
+    const qint64 first = mLevelFirst.at(level);
+    if (level == mLevels.size()-1)
+    {
+      for (qint64 i=a; i<b; ++i)
+        accumulate(result, bins.at(i-first));
+      break;
+    }
+    while (a < b && a % pyramidFanout != 0)
+      accumulate(result, bins.at((a++)-first));
+    while (b > a && b % pyramidFanout != 0)
+      accumulate(result, bins.at((--b)-first));
+  }
+  
+  if (result.count == 0)
+    return false;
+  minValue = result.min;
+  maxValue = result.max;
+  if (mean)
+    *mean = result.sum/result.count;
+  return true;
+}
+
+/*!
+  Determines the smallest and largest of the \a count values starting at \a values, ignoring NaN
+  values, and adds them up in \a sum. Returns the number of values that are not NaN. If it is
+  zero, \a minValue and \a maxValue are left unchanged.
+  
+  This is the block min/max reduction used for the lowest level of the decimation pyramid and for
+  short ranges in \ref valueBounds, it can also be used to bin arbitrary value arrays, e.g. one call
+  per pixel column. Where SSE2 is available, two values are processed per instruction, with NaNs
+  masked out instead of branched on. The sum may differ from a sequential sum in the last bits.
+*/
+int QCPDataVector::reduceValues(const double *values, int count, double &minValue, double &maxValue, double &sum)
+{
+  double lowest = std::numeric_limits<double>::max();
+  double highest = -std::numeric_limits<double>::max();
+  double total = 0;
+  int valid = 0;
+  int i = 0;
+#ifdef QCP_SSE2
+  if (count >= 4)
+  {
+    // two independent accumulator sets, so consecutive iterations don't wait for each other:
+    __m128d lowest2 = _mm_set1_pd(lowest), lowestB = lowest2;
+    __m128d highest2 = _mm_set1_pd(highest), highestB = highest2;
+    __m128d total2 = _mm_setzero_pd(), totalB = total2;
+    __m128d valid2 = _mm_setzero_pd(), validB = valid2;
+    const __m128d one = _mm_set1_pd(1.0);
+    for (; i+3<count; i+=4)
+    {
+      const __m128d v = _mm_loadu_pd(values+i);
+      const __m128d w = _mm_loadu_pd(values+i+2);
+      const __m128d vOrdered = _mm_cmpord_pd(v, v); // all bits set where the value isn't NaN
+      const __m128d wOrdered = _mm_cmpord_pd(w, w);
+      lowest2 = _mm_min_pd(v, lowest2); // minpd/maxpd return the second operand if the first is NaN
+      lowestB = _mm_min_pd(w, lowestB);
+      highest2 = _mm_max_pd(v, highest2);
+      highestB = _mm_max_pd(w, highestB);
+      total2 = _mm_add_pd(total2, _mm_and_pd(v, vOrdered));
+      totalB = _mm_add_pd(totalB, _mm_and_pd(w, wOrdered));
+      valid2 = _mm_add_pd(valid2, _mm_and_pd(one, vOrdered));
+      validB = _mm_add_pd(validB, _mm_and_pd(one, wOrdered));
+    }
+    lowest2 = _mm_min_pd(lowest2, lowestB);
+    highest2 = _mm_max_pd(highest2, highestB);
+    total2 = _mm_add_pd(total2, totalB);
+    valid2 = _mm_add_pd(valid2, validB);
+    double lanes[2];
+    _mm_storeu_pd(lanes, lowest2);
+    lowest = qMin(lanes[0], lanes[1]);
+    _mm_storeu_pd(lanes, highest2);
+    highest = qMax(lanes[0], lanes[1]);
+    _mm_storeu_pd(lanes, total2);
+    total = lanes[0]+lanes[1];
+    _mm_storeu_pd(lanes, valid2);
+    valid = static_cast<int>(lanes[0]+lanes[1]);
+  }
+#endif
+  for (; i<count; ++i)
+  {
+    const double v = values[i];
+    if (qIsNaN(v)) continue;
+    if (v < lowest)
+      lowest = v;
+    if (v > highest)
+      highest = v;
+    total += v;
+    ++valid;
+  }
+  if (valid > 0)
+  {
+    minValue = lowest;
+    maxValue = highest;
+  }
+  sum += total;
+  return valid;
+}
+
+/*! \internal
+  
+  Inserts the data point at its sorted position, after existing points with the same key.
+*/
+void QCPDataVector::insert(double key, double value)
+{
+  int index = mBegin+upperBound(key);
+  mKeys.insert(index, key);
+  mValues.insert(index, value);
+  invalidatePyramid();
+}
+
+/*! \internal
+  
+  Removes the data points with indices in the range [\a from, \a to).
+*/
+void QCPDataVector::erase(int from, int to)
+{
+  if (from >= to) return;
+  if (from == 0)
+  {
+    removeFirst(to);
+    return;
+  }
+  mKeys.remove(mBegin+from, to-from);
+  mValues.remove(mBegin+from, to-from);
+  invalidatePyramid();
+}
+
+/*! \internal
+  
+  Moves the used part of the arrays to their front, releasing the space of removed points.
+*/
+void QCPDataVector::compact()
+{
+  if (mBegin == 0) return;
+  mKeys.remove(0, mBegin);
+  mValues.remove(0, mBegin);
+  mBegin = 0;
+}
+
+/*! \internal
+  
+  Discards the decimation pyramid after a modification that can't be applied incrementally. It is
+  rebuilt on the next call of \ref valueBounds. The same modifications also advance \ref revision.
+*/
+void QCPDataVector::invalidatePyramid()
+{
+  ++mRevision;
+  mLevels.clear();
+  mLevelFirst.clear();
+  mPyramidValid = false;
+}
+
+/*! \internal
+  
+  Builds all levels of the decimation pyramid from the current data. Levels are added until the top
+  level has at most \ref pyramidFanout bins.
+*/
+void QCPDataVector::buildPyramid() const
+{
+  mLevels.clear();
+  mLevelFirst.clear();
+  const double *data = mValues.constData()+mBegin;
+  const int n = size();
+  qint64 childFirst = mFirstIndex; // running index of the first element of the level below
+  int childCount = n;
+  while (childCount > pyramidFanout)
+  {
+    const qint64 first = childFirst/pyramidFanout;
+    const qint64 last = (childFirst+childCount-1)/pyramidFanout;
+    QVector<PyramidBin> bins(static_cast<int>(last-first+1));
+    for (int i=0; i<bins.size(); ++i)
+    {
+      bins[i].min = std::numeric_limits<double>::max();
+      bins[i].max = -std::numeric_limits<double>::max();
+      bins[i].sum = 0;
+      bins[i].count = 0;
+    }
+    if (mLevels.isEmpty())
+    {
+      // the first bin may be partial if points were removed from the front, all others start at a bin boundary:
+      int begin = 0;
+      for (int b=0; b<bins.size(); ++b)
+      {
+        const int end = qMin(childCount, static_cast<int>((first+b+1)*pyramidFanout-childFirst));
+        accumulate(bins[b], data+begin, end-begin);
+        begin = end;
+      }
+    } else
+    {
+      const QVector<PyramidBin> &children = mLevels.last();
+      for (int i=0; i<childCount; ++i)
+        accumulate(bins[(childFirst+i)/pyramidFanout-first], children.at(i));
+    }
+    mLevels.append(bins);
+    mLevelFirst.append(first);
+    childFirst = first;
+    childCount = bins.size();
+  }
+  mPyramidValid = true;
+}
+
+/*! \internal
+  
+  Adds the just appended \a value to the decimation pyramid, creating new bins and a new top level
+  as necessary.
+*/
+void QCPDataVector::updatePyramid(double value)
+{
+  qint64 index = mFirstIndex+size()-1;
+  for (int level=0; level<mLevels.size(); ++level)
+  {
+    index /= pyramidFanout;
+    QVector<PyramidBin> &bins = mLevels[level];
+    const int local = index-mLevelFirst.at(level);
+    if (local == bins.size())
+    {
+      PyramidBin bin;
+      bin.min = std::numeric_limits<double>::max();
+      bin.max = -std::numeric_limits<double>::max();
+      bin.sum = 0;
+      bin.count = 0;
+      bins.append(bin);
+    }
+    accumulate(bins[local], value);
+  }
+  // the data outgrew the pyramid, rebuild to add levels:
+  if (mLevels.isEmpty() ? size() > pyramidFanout : mLevels.last().size() > pyramidFanout)
+    buildPyramid();
+}
+
+/*! \internal
+  
+  Drops bins of the decimation pyramid that only cover data points removed from the front. Like
+  the data arrays, the bin arrays are only compacted once more than half of them is unused.
+*/
+void QCPDataVector::trimPyramid()
+{
+  qint64 index = mFirstIndex;
+  for (int level=0; level<mLevels.size(); ++level)
+  {
+    index /= pyramidFanout;
+    QVector<PyramidBin> &bins = mLevels[level];
+    const int unused = index-mLevelFirst.at(level);
+    if (unused > bins.size()/2)
+    {
+      bins.remove(0, unused);
+      mLevelFirst[level] = index;
+    }
+  }
+}
+
+/*! \internal
+  
+  Merges \a value into \a bin. NaN values are ignored.
+*/
+void QCPDataVector::accumulate(PyramidBin &bin, double value)
+{
+  if (qIsNaN(value)) return;
+  if (value < bin.min)
+    bin.min = value;
+  if (value > bin.max)
+    bin.max = value;
+  bin.sum += value;
+  ++bin.count;
+}
+
+/*! \internal
+  
+  \overload
+  
+  Merges the bin \a other into \a bin.
+*/
+void QCPDataVector::accumulate(PyramidBin &bin, const PyramidBin &other)
+{
+  if (other.count == 0) return;
+  if (other.min < bin.min)
+    bin.min = other.min;
+  if (other.max > bin.max)
+    bin.max = other.max;
+  bin.sum += other.sum;
+  bin.count += other.count;
+}
+
+/*! \internal
+  
+  \overload
+  
+  Merges the \a count values starting at \a values into \a bin, see \ref reduceValues.
+*/
+void QCPDataVector::accumulate(PyramidBin &bin, const double *values, int count)
+{
+  double minValue, maxValue, sum = 0;
+  const int valid = reduceValues(values, count, minValue, maxValue, sum);
+  if (valid == 0) return;
+  if (minValue < bin.min)
+    bin.min = minValue;
+  if (maxValue > bin.max)
+    bin.max = maxValue;
+  bin.sum += sum;
+  bin.count += valid;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPGraph
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -14484,6 +15868,14 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   QCPAbstractPlottable(keyAxis, valueAxis)
 {
   mData = new QCPDataMap;
+  mDataVector = new QCPDataVector;
+  mDataBackend = dbMap;
+  mIncrementBegin = mIncrementEnd = -1;
+  mIncrementRevision = 0;
+  mHitTestOrigin = 0;
+  mHitTestEnd = -1;
+  mHitTestLineStyle = lsNone;
+  mHitTestValid = false;
   
   setPen(QPen(Qt::blue, 0));
   setErrorPen(QPen(Qt::black));
@@ -14502,6 +15894,7 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
 QCPGraph::~QCPGraph()
 {
   delete mData;
+  delete mDataVector;
 }
 
 /*!
@@ -14529,6 +15922,11 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
     delete mData;
     mData = data;
   }
+  if (mDataBackend == dbVector)
+  {
+    mDataVector->assign(*mData);
+    mData->clear();
+  }
 }
 
 /*! \overload
@@ -14539,6 +15937,11 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
 */
 void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 {
+  if (mDataBackend == dbVector)
+  {
+    mDataVector->assign(key, value);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14562,6 +15965,11 @@ void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueError)
 {
+  if (mDataBackend == dbVector) // error bars aren't stored in the vector backend
+  {
+    mDataVector->assign(key, value);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14588,6 +15996,11 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
+  if (mDataBackend == dbVector) // error bars aren't stored in the vector backend
+  {
+    mDataVector->assign(key, value);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14615,6 +16028,11 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError)
 {
+  if (mDataBackend == dbVector) // error bars aren't stored in the vector backend
+  {
+    mDataVector->assign(key, value);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14641,6 +16059,11 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus)
 {
+  if (mDataBackend == dbVector) // error bars aren't stored in the vector backend
+  {
+    mDataVector->assign(key, value);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14668,6 +16091,11 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError, const QVector<double> &valueError)
 {
+  if (mDataBackend == dbVector) // error bars aren't stored in the vector backend
+  {
+    mDataVector->assign(key, value);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14697,6 +16125,11 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
+  if (mDataBackend == dbVector) // error bars aren't stored in the vector backend
+  {
+    mDataVector->assign(key, value);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -14851,6 +16284,41 @@ void QCPGraph::setAdaptiveSampling(bool enabled)
   mAdaptiveSampling = enabled;
 }
 
+/*!
+  Sets the container that holds the graph's data. Existing data is transferred to the new
+  container.
+  
+  The default \ref dbMap stores data in a \ref QCPDataMap and supports error bars. \ref dbVector
+  stores keys and values in a contiguous \ref QCPDataVector, which is much faster and more compact
+  when data is added with monotonically increasing keys, as is typical for live data acquisition.
+  Error bars are not stored with \ref dbVector, so error bar information is lost when switching to
+  it.
+  
+  With \ref dbVector, \ref data returns an empty map; access the data via \ref dataVector instead.
+  All other methods (\ref setData, \ref addData, \ref removeData etc.) work with either backend.
+*/
+void QCPGraph::setDataBackend(DataBackend backend)
+{
+  if (mDataBackend == backend) return;
+  if (backend == dbVector)
+  {
+    mDataVector->assign(*mData);
+    mData->clear();
+  } else
+  {
+    mData->clear();
+    QCPData newData;
+    for (int i=0; i<mDataVector->size(); ++i)
+    {
+      newData.key = mDataVector->key(i);
+      newData.value = mDataVector->value(i);
+      mData->insertMulti(newData.key, newData);
+    }
+    mDataVector->clear();
+  }
+  mDataBackend = backend;
+}
+
 /*!
   Adds the provided data points in \a dataMap to the current data.
   
@@ -14861,6 +16329,12 @@ void QCPGraph::setAdaptiveSampling(bool enabled)
 */
 void QCPGraph::addData(const QCPDataMap &dataMap)
 {
+  if (mDataBackend == dbVector)
+  {
+    for (QCPDataMap::const_iterator it = dataMap.constBegin(); it != dataMap.constEnd(); ++it)
+      mDataVector->add(it.key(), it.value().value);
+    return;
+  }
   mData->unite(dataMap);
 }
 
@@ -14874,6 +16348,11 @@ void QCPGraph::addData(const QCPDataMap &dataMap)
 */
 void QCPGraph::addData(const QCPData &data)
 {
+  if (mDataBackend == dbVector)
+  {
+    mDataVector->add(data.key, data.value);
+    return;
+  }
   mData->insertMulti(data.key, data);
 }
 
@@ -14887,6 +16366,11 @@ void QCPGraph::addData(const QCPData &data)
 */
 void QCPGraph::addData(double key, double value)
 {
+  if (mDataBackend == dbVector)
+  {
+    mDataVector->add(key, value);
+    return;
+  }
   QCPData newData;
   newData.key = key;
   newData.value = value;
@@ -14896,6 +16380,10 @@ void QCPGraph::addData(double key, double value)
 /*! \overload
   Adds the provided data points as \a key and \a value pairs to the current data.
   
+  Keys that are not smaller than the current last key are appended with an insertion hint, so
+  adding a batch of monotonically increasing keys (typical for live data) doesn't need a full tree
+  lookup per point.
+  
   Alternatively, you can also access and modify the graph's data via the \ref data method, which
   returns a pointer to the internal \ref QCPDataMap.
   
@@ -14903,12 +16391,24 @@ void QCPGraph::addData(double key, double value)
 */
 void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values)
 {
+  if (mDataBackend == dbVector)
+  {
+    mDataVector->add(keys, values);
+    return;
+  }
   int n = qMin(keys.size(), values.size());
   QCPData newData;
   for (int i=0; i<n; ++i)
   {
     newData.key = keys[i];
     newData.value = values[i];
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+    if (mData->isEmpty() || newData.key >= mData->lastKey())
+    {
+      mData->insertMulti(mData->constEnd(), newData.key, newData);
+      continue;
+    }
+#endif
     mData->insertMulti(newData.key, newData);
   }
 }
@@ -14919,6 +16419,11 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 */
 void QCPGraph::removeDataBefore(double key)
 {
+  if (mDataBackend == dbVector)
+  {
+    mDataVector->removeBefore(key);
+    return;
+  }
   QCPDataMap::iterator it = mData->begin();
   while (it != mData->end() && it.key() < key)
     it = mData->erase(it);
@@ -14930,6 +16435,11 @@ void QCPGraph::removeDataBefore(double key)
 */
 void QCPGraph::removeDataAfter(double key)
 {
+  if (mDataBackend == dbVector)
+  {
+    mDataVector->removeAfter(key);
+    return;
+  }
   if (mData->isEmpty()) return;
   QCPDataMap::iterator it = mData->upperBound(key);
   while (it != mData->end())
@@ -14945,6 +16455,11 @@ void QCPGraph::removeDataAfter(double key)
 */
 void QCPGraph::removeData(double fromKey, double toKey)
 {
+  if (mDataBackend == dbVector)
+  {
+    mDataVector->remove(fromKey, toKey);
+    return;
+  }
   if (fromKey >= toKey || mData->isEmpty()) return;
   QCPDataMap::iterator it = mData->upperBound(fromKey);
   QCPDataMap::iterator itEnd = mData->upperBound(toKey);
@@ -14962,6 +16477,11 @@ void QCPGraph::removeData(double fromKey, double toKey)
 */
 void QCPGraph::removeData(double key)
 {
+  if (mDataBackend == dbVector)
+  {
+    mDataVector->remove(key);
+    return;
+  }
   mData->remove(key);
 }
 
@@ -14972,13 +16492,14 @@ void QCPGraph::removeData(double key)
 void QCPGraph::clearData()
 {
   mData->clear();
+  mDataVector->clear();
 }
 
 /* inherits documentation from base class */
 double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
 {
   Q_UNUSED(details)
-  if ((onlySelectable && !mSelectable) || mData->isEmpty())
+  if ((onlySelectable && !mSelectable) || dataCount() == 0)
     return -1;
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return -1; }
   
@@ -15012,7 +16533,7 @@ void QCPGraph::rescaleKeyAxis(bool onlyEnlarge, bool includeErrorBars) const
 {
   // this code is a copy of QCPAbstractPlottable::rescaleKeyAxis with the only change
   // that getKeyRange is passed the includeErrorBars value.
-  if (mData->isEmpty()) return;
+  if (dataCount() == 0) return;
   
   QCPAxis *keyAxis = mKeyAxis.data();
   if (!keyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
@@ -15048,7 +16569,7 @@ void QCPGraph::rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const
 {
   // this code is a copy of QCPAbstractPlottable::rescaleValueAxis with the only change
   // is that getValueRange is passed the includeErrorBars value.
-  if (mData->isEmpty()) return;
+  if (dataCount() == 0) return;
   
   QCPAxis *valueAxis = mValueAxis.data();
   if (!valueAxis) { qDebug() << Q_FUNC_INFO << "invalid value axis"; return; }
@@ -15076,8 +16597,9 @@ void QCPGraph::rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const
 /* inherits documentation from base class */
 void QCPGraph::draw(QCPPainter *painter)
 {
+  mHitTestValid = false; // a new frame, the hit test index is rebuilt on demand
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
-  if (mKeyAxis.data()->range().size() <= 0 || mData->isEmpty()) return;
+  if (mKeyAxis.data()->range().size() <= 0 || dataCount() == 0) return;
   if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
   
   // allocate line and (if necessary) point vectors:
@@ -15115,10 +16637,88 @@ void QCPGraph::draw(QCPPainter *painter)
   if (scatterData)
     drawScatterPlot(painter, scatterData);
   
-  // free allocated line and point vectors:
-  delete lineData;
-  if (scatterData)
-    delete scatterData;
+  // free allocated line and point vectors:
+  delete lineData;
+  if (scatterData)
+    delete scatterData;
+}
+
+/*! \internal
+  
+  Draws only the line segments to the points appended since the layer buffer of this graph was last
+  updated (see \ref QCPLayer::lmIncremental). The first new segment starts at the last point that
+  was drawn before, so the appended part continues the line seamlessly. With adaptive sampling, the
+  new points are reduced to a few points per pixel column, like in a full draw.
+  
+  This is only possible for graphs with the \ref dbVector backend, line style \ref lsLine, no
+  scatters and no fill, and only if the data was modified by appending and by removing points that
+  are not on the layer buffer. Otherwise false is returned and the layer is re-rendered completely.
+  
+  The appended segments are also added to the hit test index (see \ref extendHitTestIndex), so it
+  stays valid while the graph is only drawn incrementally.
+*/
+bool QCPGraph::drawIncrement(QCPPainter *painter)
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return false; }
+  if (mDataBackend != dbVector || mLineStyle != lsLine || !mScatterStyle.isNone() || mBrush.style() != Qt::NoBrush || mChannelFillGraph)
+    return false;
+  if (mIncrementEnd < 0 || mIncrementRevision != mDataVector->revision())
+    return false;
+  const qint64 first = mDataVector->firstIndex();
+  if (first > mIncrementBegin) // points that are on the layer buffer were removed
+    return false;
+  
+  // new points, starting at the last drawn one and ending at the first one beyond the key range:
+  int lower = int(qMax(mIncrementEnd-1, first)-first);
+  int upperEnd = qMin(mDataVector->size(), mDataVector->upperBound(keyAxis->range().upper)+1);
+  lower = qMax(lower, mDataVector->lowerBound(keyAxis->range().lower)-1);
+  if (upperEnd-lower >= 2)
+  {
+    QVector<QCPData> lineData;
+    const double *keys = mDataVector->keys();
+    const double *values = mDataVector->values();
+    int keyPixelSpan = qAbs(keyAxis->coordToPixel(keys[lower])-keyAxis->coordToPixel(keys[upperEnd-1]));
+    if (mAdaptiveSampling && upperEnd-lower >= 2*keyPixelSpan+2)
+      getSampledVectorLineData(&lineData, lower, upperEnd);
+    else
+    {
+      lineData.reserve(upperEnd-lower);
+      for (int i=lower; i<upperEnd; ++i)
+        lineData.append(QCPData(keys[i], values[i]));
+    }
+    
+    QVector<QPointF> linePixelData(lineData.size());
+    dataToPixels(lineData, linePixelData.data());
+    drawLinePlot(painter, &linePixelData);
+    extendHitTestIndex(first+lower, first+upperEnd, linePixelData);
+  }
+  mIncrementEnd = first+qMax(upperEnd, lower+1);
+  return true;
+}
+
+/*! \internal
+  
+  Records which data points were drawn by the last full draw into the layer buffer, so \ref
+  drawIncrement can continue from there.
+*/
+void QCPGraph::setIncrementBase()
+{
+  mIncrementBegin = mIncrementEnd = -1;
+  if (mDataBackend != dbVector)
+    return;
+  int lower, upper;
+  getVisibleDataBounds(lower, upper);
+  const qint64 first = mDataVector->firstIndex();
+  if (upper < lower) // no data
+    mIncrementBegin = mIncrementEnd = first;
+  else
+  {
+    mIncrementBegin = first+lower;
+    mIncrementEnd = first+upper+1;
+  }
+  mIncrementRevision = mDataVector->revision();
 }
 
 /* inherits documentation from base class */
@@ -15227,21 +16827,7 @@ void QCPGraph::getLinePlotData(QVector<QPointF> *linePixelData, QVector<QCPData>
   linePixelData->resize(lineData.size());
   
   // transform lineData points to pixels:
-  if (keyAxis->orientation() == Qt::Vertical)
-  {
-    for (int i=0; i<lineData.size(); ++i)
-    {
-      (*linePixelData)[i].setX(valueAxis->coordToPixel(lineData.at(i).value));
-      (*linePixelData)[i].setY(keyAxis->coordToPixel(lineData.at(i).key));
-    }
-  } else // key axis is horizontal
-  {
-    for (int i=0; i<lineData.size(); ++i)
-    {
-      (*linePixelData)[i].setX(keyAxis->coordToPixel(lineData.at(i).key));
-      (*linePixelData)[i].setY(valueAxis->coordToPixel(lineData.at(i).value));
-    }
-  }
+  dataToPixels(lineData, linePixelData->data());
 }
 
 /*!
@@ -15266,33 +16852,27 @@ void QCPGraph::getStepLeftPlotData(QVector<QPointF> *linePixelData, QVector<QCPD
   getPreparedData(&lineData, scatterData);
   linePixelData->reserve(lineData.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
   linePixelData->resize(lineData.size()*2);
+  QVector<QPointF> points(lineData.size());
+  dataToPixels(lineData, points.data());
   
-  // calculate steps from lineData and transform to pixel coordinates:
+  // calculate steps from the points transformed to pixel coordinates:
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    double lastValue = valueAxis->coordToPixel(lineData.first().value);
-    double key;
-    for (int i=0; i<lineData.size(); ++i)
+    double lastValue = points.first().x();
+    for (int i=0; i<points.size(); ++i)
     {
-      key = keyAxis->coordToPixel(lineData.at(i).key);
-      (*linePixelData)[i*2+0].setX(lastValue);
-      (*linePixelData)[i*2+0].setY(key);
-      lastValue = valueAxis->coordToPixel(lineData.at(i).value);
-      (*linePixelData)[i*2+1].setX(lastValue);
-      (*linePixelData)[i*2+1].setY(key);
+      (*linePixelData)[i*2+0] = QPointF(lastValue, points.at(i).y());
+      (*linePixelData)[i*2+1] = points.at(i);
+      lastValue = points.at(i).x();
     }
   } else // key axis is horizontal
   {
-    double lastValue = valueAxis->coordToPixel(lineData.first().value);
-    double key;
-    for (int i=0; i<lineData.size(); ++i)
+    double lastValue = points.first().y();
+    for (int i=0; i<points.size(); ++i)
     {
-      key = keyAxis->coordToPixel(lineData.at(i).key);
-      (*linePixelData)[i*2+0].setX(key);
-      (*linePixelData)[i*2+0].setY(lastValue);
-      lastValue = valueAxis->coordToPixel(lineData.at(i).value);
-      (*linePixelData)[i*2+1].setX(key);
-      (*linePixelData)[i*2+1].setY(lastValue);
+      (*linePixelData)[i*2+0] = QPointF(points.at(i).x(), lastValue);
+      (*linePixelData)[i*2+1] = points.at(i);
+      lastValue = points.at(i).y();
     }
   }
 }
@@ -15319,33 +16899,27 @@ void QCPGraph::getStepRightPlotData(QVector<QPointF> *linePixelData, QVector<QCP
   getPreparedData(&lineData, scatterData);
   linePixelData->reserve(lineData.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
   linePixelData->resize(lineData.size()*2);
+  QVector<QPointF> points(lineData.size());
+  dataToPixels(lineData, points.data());
   
-  // calculate steps from lineData and transform to pixel coordinates:
+  // calculate steps from the points transformed to pixel coordinates:
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    double lastKey = keyAxis->coordToPixel(lineData.first().key);
-    double value;
-    for (int i=0; i<lineData.size(); ++i)
+    double lastKey = points.first().y();
+    for (int i=0; i<points.size(); ++i)
     {
-      value = valueAxis->coordToPixel(lineData.at(i).value);
-      (*linePixelData)[i*2+0].setX(value);
-      (*linePixelData)[i*2+0].setY(lastKey);
-      lastKey = keyAxis->coordToPixel(lineData.at(i).key);
-      (*linePixelData)[i*2+1].setX(value);
-      (*linePixelData)[i*2+1].setY(lastKey);
+      (*linePixelData)[i*2+0] = QPointF(points.at(i).x(), lastKey);
+      (*linePixelData)[i*2+1] = points.at(i);
+      lastKey = points.at(i).y();
     }
   } else // key axis is horizontal
   {
-    double lastKey = keyAxis->coordToPixel(lineData.first().key);
-    double value;
-    for (int i=0; i<lineData.size(); ++i)
+    double lastKey = points.first().x();
+    for (int i=0; i<points.size(); ++i)
     {
-      value = valueAxis->coordToPixel(lineData.at(i).value);
-      (*linePixelData)[i*2+0].setX(lastKey);
-      (*linePixelData)[i*2+0].setY(value);
-      lastKey = keyAxis->coordToPixel(lineData.at(i).key);
-      (*linePixelData)[i*2+1].setX(lastKey);
-      (*linePixelData)[i*2+1].setY(value);
+      (*linePixelData)[i*2+0] = QPointF(lastKey, points.at(i).y());
+      (*linePixelData)[i*2+1] = points.at(i);
+      lastKey = points.at(i).x();
     }
   }
 }
@@ -15372,47 +16946,30 @@ void QCPGraph::getStepCenterPlotData(QVector<QPointF> *linePixelData, QVector<QC
   getPreparedData(&lineData, scatterData);
   linePixelData->reserve(lineData.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
   linePixelData->resize(lineData.size()*2);
-  // calculate steps from lineData and transform to pixel coordinates:
+  QVector<QPointF> points(lineData.size());
+  dataToPixels(lineData, points.data());
+  // calculate steps from the points transformed to pixel coordinates:
+  (*linePixelData)[0] = points.first();
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    double lastKey = keyAxis->coordToPixel(lineData.first().key);
-    double lastValue = valueAxis->coordToPixel(lineData.first().value);
     double key;
-    (*linePixelData)[0].setX(lastValue);
-    (*linePixelData)[0].setY(lastKey);
-    for (int i=1; i<lineData.size(); ++i)
-    {
-      key = (keyAxis->coordToPixel(lineData.at(i).key)+lastKey)*0.5;
-      (*linePixelData)[i*2-1].setX(lastValue);
-      (*linePixelData)[i*2-1].setY(key);
-      lastValue = valueAxis->coordToPixel(lineData.at(i).value);
-      lastKey = keyAxis->coordToPixel(lineData.at(i).key);
-      (*linePixelData)[i*2+0].setX(lastValue);
-      (*linePixelData)[i*2+0].setY(key);
-    }
-    (*linePixelData)[lineData.size()*2-1].setX(lastValue);
-    (*linePixelData)[lineData.size()*2-1].setY(lastKey);
+    for (int i=1; i<points.size(); ++i)
+    {
+      key = (points.at(i).y()+points.at(i-1).y())*0.5;
+      (*linePixelData)[i*2-1] = QPointF(points.at(i-1).x(), key);
+      (*linePixelData)[i*2+0] = QPointF(points.at(i).x(), key);
+    }
   } else // key axis is horizontal
   {
-    double lastKey = keyAxis->coordToPixel(lineData.first().key);
-    double lastValue = valueAxis->coordToPixel(lineData.first().value);
     double key;
-    (*linePixelData)[0].setX(lastKey);
-    (*linePixelData)[0].setY(lastValue);
-    for (int i=1; i<lineData.size(); ++i)
+    for (int i=1; i<points.size(); ++i)
     {
-      key = (keyAxis->coordToPixel(lineData.at(i).key)+lastKey)*0.5;
-      (*linePixelData)[i*2-1].setX(key);
-      (*linePixelData)[i*2-1].setY(lastValue);
-      lastValue = valueAxis->coordToPixel(lineData.at(i).value);
-      lastKey = keyAxis->coordToPixel(lineData.at(i).key);
-      (*linePixelData)[i*2+0].setX(key);
-      (*linePixelData)[i*2+0].setY(lastValue);
+      key = (points.at(i).x()+points.at(i-1).x())*0.5;
+      (*linePixelData)[i*2-1] = QPointF(key, points.at(i-1).y());
+      (*linePixelData)[i*2+0] = QPointF(key, points.at(i).y());
     }
-    (*linePixelData)[lineData.size()*2-1].setX(lastKey);
-    (*linePixelData)[lineData.size()*2-1].setY(lastValue);
   }
-
+  (*linePixelData)[points.size()*2-1] = points.last();
 }
 
 /*!
@@ -15436,33 +16993,88 @@ void QCPGraph::getImpulsePlotData(QVector<QPointF> *linePixelData, QVector<QCPDa
   QVector<QCPData> lineData;
   getPreparedData(&lineData, scatterData);
   linePixelData->resize(lineData.size()*2); // no need to reserve 2 extra points because impulse plot has no fill
+  QVector<QPointF> points(lineData.size());
+  dataToPixels(lineData, points.data());
   
-  // transform lineData points to pixels:
+  // connect the points transformed to pixels with the zero-value-line:
   if (keyAxis->orientation() == Qt::Vertical)
   {
     double zeroPointX = valueAxis->coordToPixel(0);
-    double key;
-    for (int i=0; i<lineData.size(); ++i)
+    for (int i=0; i<points.size(); ++i)
     {
-      key = keyAxis->coordToPixel(lineData.at(i).key);
-      (*linePixelData)[i*2+0].setX(zeroPointX);
-      (*linePixelData)[i*2+0].setY(key);
-      (*linePixelData)[i*2+1].setX(valueAxis->coordToPixel(lineData.at(i).value));
-      (*linePixelData)[i*2+1].setY(key);
+      (*linePixelData)[i*2+0] = QPointF(zeroPointX, points.at(i).y());
+      (*linePixelData)[i*2+1] = points.at(i);
     }
   } else // key axis is horizontal
   {
     double zeroPointY = valueAxis->coordToPixel(0);
-    double key;
-    for (int i=0; i<lineData.size(); ++i)
+    for (int i=0; i<points.size(); ++i)
     {
-      key = keyAxis->coordToPixel(lineData.at(i).key);
-      (*linePixelData)[i*2+0].setX(key);
-      (*linePixelData)[i*2+0].setY(zeroPointY);
-      (*linePixelData)[i*2+1].setX(key);
-      (*linePixelData)[i*2+1].setY(valueAxis->coordToPixel(lineData.at(i).value));
+      (*linePixelData)[i*2+0] = QPointF(points.at(i).x(), zeroPointY);
+      (*linePixelData)[i*2+1] = points.at(i);
+    }
+  }
+}
+
+/*! \internal
+  
+  Transforms the key/value pairs of \a data to pixel coordinates and writes them to \a pixels,
+  which must have room for <tt>data.size()</tt> points. The x and y of each pixel point are taken
+  from the key or value axis, depending on the key axis orientation.
+  
+  If both axes are linear, one SSE2 multiply-add transforms a whole point where available, because
+  key and value are adjacent in QCPData just like x and y in QPointF. Otherwise each axis
+  transforms its column with \ref QCPAxis::coordsToPixels.
+  
+  This is the batch replacement for calling \ref QCPAxis::coordToPixel per point, used by all
+  "get(...)PlotData" functions, \ref drawScatterPlot and \ref pointDistance.
+*/
+void QCPGraph::dataToPixels(const QVector<QCPData> &data, QPointF *pixels) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (data.isEmpty())
+    return;
+  
+  const bool keyIsX = keyAxis->orientation() == Qt::Horizontal;
+#ifdef QCP_SSE2
+  double keyScale, keyOffset, valueScale, valueOffset;
+  if (keyAxis->linearTransform(&keyScale, &keyOffset) && valueAxis->linearTransform(&valueScale, &valueOffset))
+  {
+    Q_STATIC_ASSERT(offsetof(QCPData, value) == offsetof(QCPData, key)+sizeof(double));
+    Q_STATIC_ASSERT(sizeof(QPointF) == 2*sizeof(double));
+    const QCPData *source = data.constData();
+    double *target = reinterpret_cast<double*>(pixels);
+    const int count = data.size();
+    if (keyIsX)
+    {
+      const __m128d scale = _mm_set_pd(valueScale, keyScale); // _mm_set_pd takes the upper lane first
+      const __m128d offset = _mm_set_pd(valueOffset, keyOffset);
+      for (int i=0; i<count; ++i)
+        _mm_storeu_pd(target+2*i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(&source[i].key), scale), offset));
+    } else // key axis is vertical, swap key and value to get (x, y)
+    {
+      const __m128d scale = _mm_set_pd(keyScale, valueScale);
+      const __m128d offset = _mm_set_pd(keyOffset, valueOffset);
+      for (int i=0; i<count; ++i)
+      {
+        const __m128d point = _mm_loadu_pd(&source[i].key);
+        _mm_storeu_pd(target+2*i, _mm_add_pd(_mm_mul_pd(_mm_shuffle_pd(point, point, 1), scale), offset));
+      }
     }
+    return;
   }
+#endif
+#ifndef QT_COORD_TYPE
+  const int dataStride = sizeof(QCPData)/sizeof(double);
+  const int pixelStride = sizeof(QPointF)/sizeof(double);
+  keyAxis->coordsToPixels(&data.constData()->key, keyIsX ? &pixels->rx() : &pixels->ry(), data.size(), dataStride, pixelStride);
+  valueAxis->coordsToPixels(&data.constData()->value, keyIsX ? &pixels->ry() : &pixels->rx(), data.size(), dataStride, pixelStride);
+#else // qreal isn't double, so the axes can't write into QPointF directly
+  for (int i=0; i<data.size(); ++i)
+    pixels[i] = coordsToPixels(data.at(i).key, data.at(i).value);
+#endif
 }
 
 /*! \internal
@@ -15516,36 +17128,25 @@ void QCPGraph::drawScatterPlot(QCPPainter *painter, QVector<QCPData> *scatterDat
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
+  // transform all scatter points to pixels at once, they are already in (x, y) order for either key axis orientation:
+  QVector<QPointF> pixels(scatterData->size());
+  dataToPixels(*scatterData, pixels.data());
+  
   // draw error bars:
   if (mErrorType != etNone)
   {
     applyErrorBarsAntialiasingHint(painter);
     painter->setPen(mErrorPen);
-    if (keyAxis->orientation() == Qt::Vertical)
-    {
-      for (int i=0; i<scatterData->size(); ++i)
-        drawError(painter, valueAxis->coordToPixel(scatterData->at(i).value), keyAxis->coordToPixel(scatterData->at(i).key), scatterData->at(i));
-    } else
-    {
-      for (int i=0; i<scatterData->size(); ++i)
-        drawError(painter, keyAxis->coordToPixel(scatterData->at(i).key), valueAxis->coordToPixel(scatterData->at(i).value), scatterData->at(i));
-    }
+    for (int i=0; i<scatterData->size(); ++i)
+      drawError(painter, pixels.at(i).x(), pixels.at(i).y(), scatterData->at(i));
   }
   
   // draw scatter point symbols:
   applyScattersAntialiasingHint(painter);
   mScatterStyle.applyTo(painter, mPen);
-  if (keyAxis->orientation() == Qt::Vertical)
-  {
-    for (int i=0; i<scatterData->size(); ++i)
-      if (!qIsNaN(scatterData->at(i).value))
-        mScatterStyle.drawShape(painter, valueAxis->coordToPixel(scatterData->at(i).value), keyAxis->coordToPixel(scatterData->at(i).key));
-  } else
-  {
-    for (int i=0; i<scatterData->size(); ++i)
-      if (!qIsNaN(scatterData->at(i).value))
-        mScatterStyle.drawShape(painter, keyAxis->coordToPixel(scatterData->at(i).key), valueAxis->coordToPixel(scatterData->at(i).value));
-  }
+  for (int i=0; i<scatterData->size(); ++i)
+    if (!qIsNaN(scatterData->at(i).value))
+      mScatterStyle.drawShape(painter, pixels.at(i).x(), pixels.at(i).y());
 }
 
 /*!  \internal
@@ -15660,6 +17261,11 @@ void QCPGraph::drawImpulsePlot(QCPPainter *painter, QVector<QPointF> *lineData)
 */
 void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *scatterData) const
 {
+  if (mDataBackend == dbVector)
+  {
+    getPreparedVectorData(lineData, scatterData);
+    return;
+  }
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
@@ -15839,6 +17445,169 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
   }
 }
 
+/*!  \internal
+  
+  Same as \ref getPreparedData, for graphs using the \ref dbVector data backend.
+  
+  With adaptive sampling, the line data is reduced to at most a few points per pixel column like
+  in \ref getPreparedData, but the value span of each column is looked up in the decimation pyramid
+  of \ref QCPDataVector (see \ref QCPDataVector::valueBounds) instead of iterating over all data
+  points. Zooming out over millions of points therefore costs about as much as drawing a few
+  thousand. Scatter data is sampled by iterating the visible points, as in \ref getPreparedData.
+*/
+void QCPGraph::getPreparedVectorData(QVector<QCPData> *lineData, QVector<QCPData> *scatterData) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  // get visible data range:
+  int lower, upper; // note that upper is the actual upper point, and not 1 step after the upper point
+  getVisibleDataBounds(lower, upper);
+  if (upper < lower)
+    return;
+  const double *keys = mDataVector->keys();
+  const double *values = mDataVector->values();
+  int upperEnd = upper+1;
+  int dataCount = upperEnd-lower;
+  
+  bool useSampling = false;
+  if (mAdaptiveSampling)
+  {
+    int keyPixelSpan = qAbs(keyAxis->coordToPixel(keys[lower])-keyAxis->coordToPixel(keys[upper]));
+    useSampling = dataCount >= 2*keyPixelSpan+2; // use adaptive sampling only if there are at least two points per pixel on average
+  }
+  
+  if (useSampling)
+  {
+    if (lineData)
+      getSampledVectorLineData(lineData, lower, upperEnd);
+    
+    if (scatterData)
+    {
+      double valueMaxRange = valueAxis->range().upper;
+      double valueMinRange = valueAxis->range().lower;
+      int i = lower;
+      double minValue = values[i];
+      double maxValue = values[i];
+      int minValueIndex = i;
+      int maxValueIndex = i;
+      int currentIntervalStart = i;
+      int reversedFactor = keyAxis->rangeReversed() ? -1 : 1; // is used to calculate keyEpsilon pixel into the correct direction
+      int reversedRound = keyAxis->rangeReversed() ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
+      double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(keys[lower])+reversedRound));
+      double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+      bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
+      int intervalDataCount = 1;
+      ++i; // advance to second data point because adaptive sampling works in 1 point retrospect
+      while (i <= upperEnd)
+      {
+        bool newInterval = i == upperEnd || keys[i] >= currentIntervalStartKey+keyEpsilon;
+        if (!newInterval) // data point is still within same pixel, so skip it and expand value span of this pixel if necessary
+        {
+          if (values[i] < minValue && values[i] > valueMinRange && values[i] < valueMaxRange)
+          {
+            minValue = values[i];
+            minValueIndex = i;
+          } else if (values[i] > maxValue && values[i] > valueMinRange && values[i] < valueMaxRange)
+          {
+            maxValue = values[i];
+            maxValueIndex = i;
+          }
+          ++intervalDataCount;
+        } else // new pixel started (or end of data reached, which closes the last interval)
+        {
+          if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them
+          {
+            // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
+            double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
+            int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
+            for (int j=currentIntervalStart, c=0; j<i; ++j, ++c)
+            {
+              if ((c % dataModulo == 0 || j == minValueIndex || j == maxValueIndex) && values[j] > valueMinRange && values[j] < valueMaxRange)
+                scatterData->append(QCPData(keys[j], values[j]));
+            }
+          } else if (values[currentIntervalStart] > valueMinRange && values[currentIntervalStart] < valueMaxRange)
+            scatterData->append(QCPData(keys[currentIntervalStart], values[currentIntervalStart]));
+          if (i == upperEnd)
+            break;
+          minValue = values[i];
+          maxValue = values[i];
+          currentIntervalStart = i;
+          currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(keys[i])+reversedRound));
+          if (keyEpsilonVariable)
+            keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+          intervalDataCount = 1;
+        }
+        ++i;
+      }
+    }
+  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the arrays into the output parameters
+  {
+    QVector<QCPData> *dataVector = 0;
+    if (lineData)
+      dataVector = lineData;
+    else if (scatterData)
+      dataVector = scatterData;
+    if (dataVector)
+    {
+      dataVector->reserve(dataCount+2); // +2 for possible fill end points
+      for (int i=lower; i<upperEnd; ++i)
+        dataVector->append(QCPData(keys[i], values[i]));
+    }
+    if (lineData && scatterData)
+      *scatterData = *dataVector;
+  }
+}
+
+/*!  \internal
+  
+  Appends the adaptively sampled line data of the data vector points with indices in [\a lower, \a
+  upperEnd) to \a lineData. Used by \ref getPreparedVectorData for the visible points and by \ref
+  drawIncrement for newly appended points.
+*/
+void QCPGraph::getSampledVectorLineData(QVector<QCPData> *lineData, int lower, int upperEnd) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  const double *keys = mDataVector->keys();
+  const double *values = mDataVector->values();
+  int upper = upperEnd-1;
+  // walk the non-empty pixel columns of the key range. The points of each column are
+  // found with a binary search and their value span is taken from the decimation pyramid of the
+  // data vector, so the cost depends on the number of pixels, not on the number of data points.
+  double lowerPixel = keyAxis->coordToPixel(keys[lower]);
+  double upperPixel = keyAxis->coordToPixel(keys[upper]);
+  double pixelDir = upperPixel >= lowerPixel ? 1.0 : -1.0; // direction of increasing keys in pixel space
+  double firstPixel = pixelDir > 0 ? std::floor(lowerPixel) : std::ceil(lowerPixel);
+  double lastColumn = -2;
+  int i = lower;
+  while (i < upperEnd)
+  {
+    double column = std::floor((keyAxis->coordToPixel(keys[i])-firstPixel)*pixelDir);
+    double columnPixel = firstPixel+column*pixelDir;
+    double boundary1 = keyAxis->pixelToCoord(columnPixel);
+    double boundary2 = keyAxis->pixelToCoord(columnPixel+pixelDir);
+    double columnStartKey = qMin(boundary1, boundary2);
+    double keyEpsilon = qAbs(boundary2-boundary1); // width of this pixel column in key coordinates
+    int columnEnd = std::lower_bound(keys+i+1, keys+upperEnd, columnStartKey+keyEpsilon)-keys;
+    if (columnEnd-i == 1)
+      lineData->append(QCPData(keys[i], values[i]));
+    else
+    {
+      double minValue, maxValue;
+      if (!mDataVector->valueBounds(i, columnEnd, minValue, maxValue))
+        minValue = maxValue = values[i]; // only NaN values in this column, pass one on to create a gap
+      if (column != lastColumn+1) // previous column is empty, so first point of this cluster must be at a real data point
+        lineData->append(QCPData(columnStartKey+keyEpsilon*0.2, values[i]));
+      lineData->append(QCPData(columnStartKey+keyEpsilon*0.25, minValue));
+      lineData->append(QCPData(columnStartKey+keyEpsilon*0.75, maxValue));
+      if (columnEnd < upperEnd && keys[columnEnd] > columnStartKey+keyEpsilon*2) // next point is further away than the next column, so make sure the last point of the cluster is at a real data point
+        lineData->append(QCPData(columnStartKey+keyEpsilon*0.8, values[columnEnd-1]));
+    }
+    lastColumn = column;
+    i = columnEnd;
+  }
+}
+
 /*!  \internal
   
   called by the scatter drawing function (\ref drawScatterPlot) to draw the error bars on one data
@@ -15977,6 +17746,33 @@ void QCPGraph::getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMa
   upper = (highoutlier ? ubound : ubound-1); // data point range that will be actually drawn
 }
 
+/*!  \internal
+  
+  \overload
+  
+  Same as \ref getVisibleDataBounds for graphs using the \ref dbVector data backend, returning
+  indices into \ref QCPDataVector instead of map iterators. Both bounds are found with a binary
+  search.
+  
+  If the graph contains no data, \a upper is smaller than \a lower.
+*/
+void QCPGraph::getVisibleDataBounds(int &lower, int &upper) const
+{
+  lower = 0;
+  upper = -1;
+  if (!mKeyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
+  if (mDataVector->isEmpty())
+    return;
+  
+  int lbound = mDataVector->lowerBound(mKeyAxis.data()->range().lower);
+  int ubound = mDataVector->upperBound(mKeyAxis.data()->range().upper);
+  bool lowoutlier = lbound > 0; // indicates whether there exist points below axis range
+  bool highoutlier = ubound < mDataVector->size(); // indicates whether there exist points above axis range
+  
+  lower = (lowoutlier ? lbound-1 : lbound); // data point range that will be actually drawn
+  upper = (highoutlier ? ubound : ubound-1); // data point range that will be actually drawn
+}
+
 /*!  \internal
   
   Counts the number of data points between \a lower and \a upper (including them), up to a maximum
@@ -16394,67 +18190,181 @@ int QCPGraph::findIndexAboveY(const QVector<QPointF> *data, double y) const
   pixelPoint in pixels. This is used to determine whether the graph was clicked or not, e.g. in
   \ref selectTest.
   
+  The pixel representation of the graph and an index of it by key pixel column are built on the
+  first call after the graph was drawn and reused until it is drawn completely again (see \ref
+  buildHitTestIndex). Segments drawn incrementally are appended to it (see \ref
+  extendHitTestIndex). Only the points and line segments reaching into the columns within twice the
+  selection tolerance of \a pixelPoint are tested, so the cost doesn't grow with the number of data
+  points. Distances beyond that window aren't needed for selection: the result is then larger than
+  the window, or -1.0 if nothing of the graph lies within the columns of the window.
+  
   If either the graph has no data or if the line style is \ref lsNone and the scatter style's shape
   is \ref QCPScatterStyle::ssNone (i.e. there is no visual representation of the graph), returns -1.0.
 */
 double QCPGraph::pointDistance(const QPointF &pixelPoint) const
 {
-  if (mData->isEmpty())
+  if (dataCount() == 0)
     return -1.0;
   if (mLineStyle == lsNone && mScatterStyle.isNone())
     return -1.0;
   
+  if (!mHitTestValid || mHitTestLineStyle != mLineStyle)
+    buildHitTestIndex();
+  if (mHitTestPixels.isEmpty()) // no data available in view to calculate distance to
+    return -1.0;
+  if (mLineStyle != lsNone && mHitTestPixels.size() == 1) // only single data point, calculate distance to that point
+    return QVector2D(mHitTestPixels.at(0)-pixelPoint).length();
+  
+  // collect the points/segments reaching into the key pixel columns around pixelPoint:
+  const double radius = qMax(2.0*mParentPlot->selectionTolerance(), 1.0);
+  const double coord = mKeyAxis.data()->orientation() == Qt::Horizontal ? pixelPoint.x() : pixelPoint.y();
+  const int columns = mHitTestFirst.size();
+  const int lowerColumn = qMax(0, int(std::floor(qMax(coord-radius-mHitTestOrigin, -1.0))));
+  const int upperColumn = qMin(columns-1, int(std::floor(qMin(coord+radius-mHitTestOrigin, double(columns)))));
+  int first = std::numeric_limits<int>::max();
+  int last = -1;
+  for (int column=lowerColumn; column<=upperColumn; ++column)
+  {
+    first = qMin(first, mHitTestFirst.at(column));
+    last = qMax(last, mHitTestLast.at(column));
+  }
+  if (last < 0)
+    return -1.0;
+  
   // calculate minimum distances to graph representation:
+  double minDistSqr = std::numeric_limits<double>::max();
   if (mLineStyle == lsNone)
   {
     // no line displayed, only calculate distance to scatter points:
-    QVector<QCPData> scatterData;
-    getScatterPlotData(&scatterData);
-    if (scatterData.size() > 0)
+    for (int i=first; i<=last; ++i)
     {
-      double minDistSqr = std::numeric_limits<double>::max();
-      for (int i=0; i<scatterData.size(); ++i)
-      {
-        double currentDistSqr = QVector2D(coordsToPixels(scatterData.at(i).key, scatterData.at(i).value)-pixelPoint).lengthSquared();
-        if (currentDistSqr < minDistSqr)
-          minDistSqr = currentDistSqr;
-      }
-      return qSqrt(minDistSqr);
-    } else // no data available in view to calculate distance to
-      return -1.0;
+      double currentDistSqr = QVector2D(mHitTestPixels.at(i)-pixelPoint).lengthSquared();
+      if (currentDistSqr < minDistSqr)
+        minDistSqr = currentDistSqr;
+    }
   } else
   {
-    // line displayed, calculate distance to line segments:
-    QVector<QPointF> lineData;
-    getPlotData(&lineData, 0); // unlike with getScatterPlotData we get pixel coordinates here
-    if (lineData.size() > 1) // at least one line segment, compare distance to line segments
+    // impulse plot differs from other line styles in that the points are only pairwise connected,
+    // all other line plots (line and step) connect points directly:
+    const int step = mLineStyle == lsImpulse ? 2 : 1;
+    for (int i=first; i<=last; i+=step)
     {
-      double minDistSqr = std::numeric_limits<double>::max();
-      if (mLineStyle == lsImpulse)
-      {
-        // impulse plot differs from other line styles in that the lineData points are only pairwise connected:
-        for (int i=0; i<lineData.size()-1; i+=2) // iterate pairs
-        {
-          double currentDistSqr = distSqrToLine(lineData.at(i), lineData.at(i+1), pixelPoint);
-          if (currentDistSqr < minDistSqr)
-            minDistSqr = currentDistSqr;
-        }
-      } else
-      {
-        // all other line plots (line and step) connect points directly:
-        for (int i=0; i<lineData.size()-1; ++i)
-        {
-          double currentDistSqr = distSqrToLine(lineData.at(i), lineData.at(i+1), pixelPoint);
-          if (currentDistSqr < minDistSqr)
-            minDistSqr = currentDistSqr;
-        }
-      }
-      return qSqrt(minDistSqr);
-    } else if (lineData.size() > 0) // only single data point, calculate distance to that point
+      double currentDistSqr = distSqrToLine(mHitTestPixels.at(i), mHitTestPixels.at(i+1), pixelPoint);
+      if (currentDistSqr < minDistSqr)
+        minDistSqr = currentDistSqr;
+    }
+  }
+  return qSqrt(minDistSqr);
+}
+
+/*! \internal
+  
+  Builds the hit test index used by \ref pointDistance from the current plot data: the pixel
+  points of the graph (scatter points for line style \ref lsNone, otherwise the line as drawn) and,
+  for every pixel column of the axis rect along the key axis, the first and last index of the
+  points or line segments reaching into that column (see \ref indexHitTestSegments).
+  
+  For line graphs with the \ref dbVector backend, the data index one past the last indexed point is
+  kept, so \ref extendHitTestIndex can append segments drawn incrementally.
+*/
+void QCPGraph::buildHitTestIndex() const
+{
+  mHitTestValid = true;
+  mHitTestLineStyle = mLineStyle;
+  mHitTestEnd = -1;
+  mHitTestPixels.clear();
+  mHitTestFirst.clear();
+  mHitTestLast.clear();
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!keyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  
+  if (mLineStyle == lsNone)
+  {
+    QVector<QCPData> scatterData;
+    getScatterPlotData(&scatterData);
+    mHitTestPixels.resize(scatterData.size());
+    dataToPixels(scatterData, mHitTestPixels.data());
+  } else
+    getPlotData(&mHitTestPixels, 0); // unlike with getScatterPlotData we get pixel coordinates here
+  if (mDataBackend == dbVector && mLineStyle == lsLine)
+  {
+    int lower, upper;
+    getVisibleDataBounds(lower, upper);
+    if (upper >= lower)
+      mHitTestEnd = mDataVector->firstIndex()+upper+1;
+  }
+  
+  const bool keyIsX = keyAxis->orientation() == Qt::Horizontal;
+  const QRect rect = keyAxis->axisRect()->rect();
+  mHitTestOrigin = keyIsX ? rect.left() : rect.top();
+  const int columns = (keyIsX ? rect.width() : rect.height())+1;
+  mHitTestFirst.fill(std::numeric_limits<int>::max(), columns);
+  mHitTestLast.fill(-1, columns);
+  indexHitTestSegments(0);
+}
+
+/*! \internal
+  
+  Appends the line segments drawn by \ref drawIncrement to the hit test index. \a pixels is the
+  drawn line, covering the data points from running data vector index \a begin to one before \a
+  end. Only the new segments are indexed, so the cost is proportional to the increment and not to
+  the number of visible points.
+  
+  This is only possible if the index ends at the point the increment continues from, i.e. it was
+  built or last extended for the same line. Otherwise the index is discarded and rebuilt on demand.
+*/
+void QCPGraph::extendHitTestIndex(qint64 begin, qint64 end, const QVector<QPointF> &pixels)
+{
+  if (!mHitTestValid)
+    return;
+  if (mHitTestLineStyle != lsLine || mHitTestEnd != begin+1 || mHitTestPixels.isEmpty() || pixels.isEmpty())
+  {
+    mHitTestValid = false;
+    return;
+  }
+  const int oldSize = mHitTestPixels.size();
+  // the first drawn point continues the indexed line, don't duplicate it:
+  const int skip = pixels.first() == mHitTestPixels.last() ? 1 : 0;
+  mHitTestPixels.reserve(oldSize+pixels.size()-skip);
+  for (int i=skip; i<pixels.size(); ++i)
+    mHitTestPixels.append(pixels.at(i));
+  mHitTestEnd = end;
+  indexHitTestSegments(oldSize-1); // the first new segment starts at the previously last point
+}
+
+/*! \internal
+  
+  Enters the points or line segments of \ref mHitTestPixels starting at index \a begin into the per
+  column index \ref mHitTestFirst and \ref mHitTestLast, which must already have their size.
+  
+  Since keys are sorted, the pixel coordinates along the key axis are monotonic, so each column
+  lists a contiguous run of segments and indexing takes O(n + columns).
+*/
+void QCPGraph::indexHitTestSegments(int begin) const
+{
+  const bool keyIsX = mKeyAxis.data()->orientation() == Qt::Horizontal;
+  const int columns = mHitTestFirst.size();
+  const int step = mLineStyle == lsImpulse ? 2 : 1; // index distance between the starts of two points/segments
+  const int span = mLineStyle == lsNone ? 0 : 1; // index distance between start and end of a point/segment
+  for (int i=qMax(0, begin); i+span<mHitTestPixels.size(); i+=step)
+  {
+    double a = keyIsX ? mHitTestPixels.at(i).x() : mHitTestPixels.at(i).y();
+    double b = keyIsX ? mHitTestPixels.at(i+span).x() : mHitTestPixels.at(i+span).y();
+    if (a > b)
+      qSwap(a, b);
+    a -= mHitTestOrigin;
+    b -= mHitTestOrigin;
+    if (!(a < columns && b >= 0)) // outside of the axis rect (or NaN), can't be hit
+      continue;
+    const int lowerColumn = qMax(0, int(std::floor(a)));
+    const int upperColumn = qMin(columns-1, int(std::floor(b)));
+    for (int column=lowerColumn; column<=upperColumn; ++column)
     {
-      return QVector2D(lineData.at(0)-pixelPoint).length();
-    } else // no data available in view to calculate distance to
-      return -1.0;
+      if (i < mHitTestFirst.at(column))
+        mHitTestFirst[column] = i;
+      if (i > mHitTestLast.at(column))
+        mHitTestLast[column] = i;
+    }
   }
 }
 
@@ -16511,7 +18421,28 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
   
   double current, currentErrorMinus, currentErrorPlus;
   
-  if (inSignDomain == sdBoth) // range may be anywhere
+  if (mDataBackend == dbVector) // keys are sorted, so only the ends of the valid sign domain need to be searched
+  {
+    const double *keys = mDataVector->keys();
+    const double *values = mDataVector->values();
+    int begin = 0;
+    int end = mDataVector->size();
+    if (inSignDomain == sdNegative)
+      end = mDataVector->lowerBound(0);
+    else if (inSignDomain == sdPositive)
+      begin = mDataVector->upperBound(0);
+    while (begin < end && qIsNaN(values[begin]))
+      ++begin;
+    while (end > begin && qIsNaN(values[end-1]))
+      --end;
+    if (begin < end)
+    {
+      range.lower = keys[begin];
+      range.upper = keys[end-1];
+      haveLower = true;
+      haveUpper = true;
+    }
+  } else if (inSignDomain == sdBoth) // range may be anywhere
   {
     QCPDataMap::const_iterator it = mData->constBegin();
     while (it != mData->constEnd())
@@ -16626,7 +18557,27 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
   
   double current, currentErrorMinus, currentErrorPlus;
   
-  if (inSignDomain == sdBoth) // range may be anywhere
+  if (mDataBackend == dbVector) // no error bars, so a single pass over the value array suffices
+  {
+    const double *values = mDataVector->values();
+    int n = mDataVector->size();
+    for (int i=0; i<n; ++i)
+    {
+      current = values[i];
+      if (qIsNaN(current) || (inSignDomain == sdNegative && current >= 0) || (inSignDomain == sdPositive && current <= 0))
+        continue;
+      if (current < range.lower || !haveLower)
+      {
+        range.lower = current;
+        haveLower = true;
+      }
+      if (current > range.upper || !haveUpper)
+      {
+        range.upper = current;
+        haveUpper = true;
+      }
+    }
+  } else if (inSignDomain == sdBoth) // range may be anywhere
   {
     QCPDataMap::const_iterator it = mData->constBegin();
     while (it != mData->constEnd())
@@ -23252,6 +25203,11 @@ void QCPItemTracer::updatePosition()
   {
     if (mParentPlot->hasPlottable(mGraph))
     {
+      if (mGraph->dataBackend() == QCPGraph::dbVector)
+      {
+        updateVectorPosition();
+        return;
+      }
       if (mGraph->data()->size() > 1)
       {
         QCPDataMap::const_iterator first = mGraph->data()->constBegin();
@@ -23294,6 +25250,50 @@ void QCPItemTracer::updatePosition()
   }
 }
 
+/*! \internal
+  
+  Same as \ref updatePosition, for tracer graphs using the \ref QCPGraph::dbVector data backend.
+  The data points around the tracer key are found with a binary search.
+*/
+void QCPItemTracer::updateVectorPosition()
+{
+  const QCPDataVector *data = mGraph->dataVector();
+  if (data->size() > 1)
+  {
+    if (mGraphKey < data->firstKey())
+      position->setCoords(data->firstKey(), data->value(0));
+    else if (mGraphKey > data->lastKey())
+      position->setCoords(data->lastKey(), data->value(data->size()-1));
+    else
+    {
+      int i = data->lowerBound(mGraphKey);
+      if (i != 0) // mGraphKey is somewhere between data points
+      {
+        int prev = i-1;
+        if (mInterpolating)
+        {
+          // interpolate between data points around mGraphKey:
+          double slope = 0;
+          if (!qFuzzyCompare(data->key(i), data->key(prev)))
+            slope = (data->value(i)-data->value(prev))/(data->key(i)-data->key(prev));
+          position->setCoords(mGraphKey, (mGraphKey-data->key(prev))*slope+data->value(prev));
+        } else
+        {
+          // find data point with key closest to mGraphKey:
+          if (mGraphKey < (data->key(prev)+data->key(i))*0.5)
+            i = prev;
+          position->setCoords(data->key(i), data->value(i));
+        }
+      } else // mGraphKey is exactly on first data point
+        position->setCoords(data->key(i), data->value(i));
+    }
+  } else if (data->size() == 1)
+  {
+    position->setCoords(data->firstKey(), data->value(0));
+  } else
+    qDebug() << Q_FUNC_INFO << "graph has no data";
+}
+
 /*! \internal
 
   Returns the pen that should be used for drawing lines. Returns mPen when the item is not selected
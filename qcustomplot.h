@@ -43,8 +43,16 @@
 #include <QStack>
 #include <QCache>
 #include <QMargins>
+#include <QImage>
+#include <QPicture>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QSharedPointer>
 #include <qmath.h>
 #include <limits>
+#include <algorithm>
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #  include <qnumeric.h>
 #  include <QPrinter>
@@ -53,6 +61,13 @@
 #  include <QtNumeric>
 #  include <QtPrintSupport/QtPrintSupport>
 #endif
+#if defined(QCUSTOMPLOT_USE_OPENGL) && QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+#  define QCP_OPENGL_FBO
+#  include <QOpenGLContext>
+#  include <QOffscreenSurface>
+#  include <QOpenGLFramebufferObject>
+#  include <QOpenGLWidget>
+#endif
 
 class QCPPainter;
 class QCustomPlot;
@@ -142,6 +157,8 @@ enum PlottingHint { phNone            = 0x000 ///< <tt>0x000</tt> No hints are s
                     ,phForceRepaint   = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpHint.
                                               ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels    = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phThreadedRendering = 0x008 ///< <tt>0x008</tt> \ref QCustomPlot::replot only records the plot, the recording is rasterized into a QImage by a worker thread
+                                              ///<                (see \ref QCPThreadedRenderer). Keeps the GUI thread responsive with line-heavy plots.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -371,8 +388,20 @@ class QCP_LIB_DECL QCPLayer : public QObject
   Q_PROPERTY(int index READ index)
   Q_PROPERTY(QList<QCPLayerable*> children READ children)
   Q_PROPERTY(bool visible READ visible WRITE setVisible)
+  Q_PROPERTY(LayerMode mode READ mode WRITE setMode)
   /// \endcond
 public:
+  /*!
+    Defines how the layer is rendered during a replot.
+    
+    \see setMode
+  */
+  enum LayerMode { lmLogical      ///< Layerables are drawn directly into the paint buffer on every replot
+                   ,lmBuffered    ///< Layerables are drawn into a layer-private image which is only re-rendered when invalidated
+                   ,lmIncremental ///< Like \ref lmBuffered, but while the image is valid, layerables may draw what changed since the last replot on top of it (see \ref QCPLayerable::drawIncrement)
+                 };
+  Q_ENUMS(LayerMode)
+  
   QCPLayer(QCustomPlot* parentPlot, const QString &layerName);
   ~QCPLayer();
   
@@ -382,9 +411,14 @@ public:
   int index() const { return mIndex; }
   QList<QCPLayerable*> children() const { return mChildren; }
   bool visible() const { return mVisible; }
+  LayerMode mode() const { return mMode; }
   
   // setters:
   void setVisible(bool visible);
+  void setMode(LayerMode mode);
+  
+  // non-property methods:
+  void invalidateBuffer() { mBufferValid = false; }
   
 protected:
   // property members:
@@ -393,10 +427,19 @@ protected:
   int mIndex;
   QList<QCPLayerable*> mChildren;
   bool mVisible;
+  LayerMode mMode;
+  
+  // non-property members:
+  QImage mBuffer; // an image rather than a pixmap, so it can be handed to QCPThreadedRenderer
+  bool mBufferValid;
   
   // non-virtual methods:
   void addChild(QCPLayerable *layerable, bool prepend);
   void removeChild(QCPLayerable *layerable);
+  void drawChildren(QCPPainter *painter);
+  bool drawChildIncrements(QCPPainter *painter);
+  void updateBuffer(QCPPainter *painter);
+  void drawBuffered(QCPPainter *painter);
   
 private:
   Q_DISABLE_COPY(QCPLayer)
@@ -455,6 +498,8 @@ protected:
   virtual QRect clipRect() const;
   virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const = 0;
   virtual void draw(QCPPainter *painter) = 0;
+  virtual bool drawIncrement(QCPPainter *painter);
+  virtual void setIncrementBase();
   // events:
   virtual void selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged);
   virtual void deselectEvent(bool *selectionStateChanged);
@@ -470,6 +515,7 @@ private:
   
   friend class QCustomPlot;
   friend class QCPAxisRect;
+  friend class QCPLayer;
 };
 
 
@@ -1210,6 +1256,8 @@ public:
   void rescale(bool onlyVisiblePlottables=false);
   double pixelToCoord(double value) const;
   double coordToPixel(double value) const;
+  void coordsToPixels(const double *coords, double *pixels, int count, int coordStride=1, int pixelStride=1) const;
+  bool linearTransform(double *scale, double *offset) const;
   SelectablePart getPartAt(const QPointF &pos) const;
   QList<QCPAbstractPlottable*> plottables() const;
   QList<QCPGraph*> graphs() const;
@@ -1677,6 +1725,72 @@ private:
 };
 
 
+class QCP_LIB_DECL QCPThreadedRenderer : public QThread
+{
+  Q_OBJECT
+public:
+  /*!
+    One part of a frame: either a recording of layers that are drawn on every replot or the cached
+    image of a buffered layer (see \ref QCPLayer::setMode). If \a image is null, \a picture is
+    played.
+  */
+  struct FramePart
+  {
+    QPicture picture;
+    QImage image;
+  };
+  
+  explicit QCPThreadedRenderer(QObject *parent=0);
+  virtual ~QCPThreadedRenderer();
+  
+  // getters:
+  QImage frontBuffer() const;
+  int droppedFrames() const;
+  
+  // non-property methods:
+  void render(const QList<FramePart> &frame, const QSize &size, const QColor &fillColor);
+  
+Q_SIGNALS:
+  void frameRendered(double renderTime);
+  
+protected:
+  // non-property members:
+  mutable QMutex mMutex;
+  QWaitCondition mCondition;
+  QImage mFrontBuffer, mBackBuffer;
+  QList<FramePart> mPendingFrame;
+  QSize mPendingSize;
+  QColor mPendingFillColor;
+  bool mPending, mQuit;
+  int mDroppedFrames;
+  
+  // reimplemented virtual methods:
+  virtual void run();
+  
+private:
+  Q_DISABLE_COPY(QCPThreadedRenderer)
+};
+
+
+#ifdef QCP_OPENGL_FBO
+class QCP_LIB_DECL QCPOpenGlView : public QOpenGLWidget
+{
+public:
+  explicit QCPOpenGlView(QCustomPlot *parentPlot);
+  
+protected:
+  // non-property members:
+  QCustomPlot *mParentPlot;
+  
+  // reimplemented virtual methods:
+  virtual void paintGL();
+  
+private:
+  Q_DISABLE_COPY(QCPOpenGlView)
+};
+#endif
+
+
 class QCP_LIB_DECL QCustomPlot : public QWidget
 {
   Q_OBJECT
@@ -1729,6 +1843,7 @@ public:
   bool noAntialiasingOnDrag() const { return mNoAntialiasingOnDrag; }
   QCP::PlottingHints plottingHints() const { return mPlottingHints; }
   Qt::KeyboardModifier multiSelectModifier() const { return mMultiSelectModifier; }
+  bool openGl() const { return mOpenGl; }
 
   // setters:
   void setViewport(const QRect &rect);
@@ -1749,6 +1864,7 @@ public:
   void setPlottingHints(const QCP::PlottingHints &hints);
   void setPlottingHint(QCP::PlottingHint hint, bool enabled=true);
   void setMultiSelectModifier(Qt::KeyboardModifier modifier);
+  bool setOpenGl(bool enabled, int multisampling=16);
   
   // non-property methods:
   // plottable interface:
@@ -1795,6 +1911,7 @@ public:
   bool addLayer(const QString &name, QCPLayer *otherLayer=0, LayerInsertMode insertMode=limAbove);
   bool removeLayer(QCPLayer *layer);
   bool moveLayer(QCPLayer *layer, QCPLayer *otherLayer, LayerInsertMode insertMode=limAbove);
+  void invalidateLayerBuffers();
   
   // axis rect/layout interface:
   int axisRectCount() const;
@@ -1840,6 +1957,7 @@ Q_SIGNALS:
   void selectionChangedByUser();
   void beforeReplot();
   void afterReplot();
+  void afterRender(double renderTime);
   
 protected:
   // property members:
@@ -1862,9 +1980,17 @@ protected:
   QCPLayer *mCurrentLayer;
   QCP::PlottingHints mPlottingHints;
   Qt::KeyboardModifier mMultiSelectModifier;
+  bool mOpenGl;
   
   // non-property members:
   QPixmap mPaintBuffer;
+  QCPThreadedRenderer *mThreadedRenderer;
+  int mOpenGlMultisamples;
+#ifdef QCP_OPENGL_FBO
+  QCPOpenGlView *mGlView;
+#endif
+  bool mGlPainting;
+  QVector<double> mLayerBufferKey;
   QPoint mMousePressPos;
   QPointer<QCPLayoutElement> mMouseEventElement;
   bool mReplotting;
@@ -1886,14 +2012,21 @@ protected:
   virtual void legendRemoved(QCPLegend *legend);
   
   // non-virtual methods:
+  void replotThreaded();
+  void updateLayerBufferKey();
+  void paintOpenGl(QCPPainter *painter);
+  bool setupOpenGl();
+  void freeOpenGl();
   void updateLayerIndices() const;
   QCPLayerable *layerableAt(const QPointF &pos, bool onlySelectable, QVariant *selectionDetails=0) const;
   void drawBackground(QCPPainter *painter);
+  QVector<double> layerBufferKey() const;
   
   friend class QCPLegend;
   friend class QCPAxis;
   friend class QCPLayer;
   friend class QCPAxisRect;
+  friend class QCPOpenGlView;
 };
 
 
@@ -2487,6 +2620,74 @@ typedef QMapIterator<double, QCPData> QCPDataMapIterator;
 typedef QMutableMapIterator<double, QCPData> QCPDataMutableMapIterator;
 
 
+class QCP_LIB_DECL QCPDataVector
+{
+public:
+  QCPDataVector();
+  
+  // getters:
+  int size() const { return mKeys.size()-mBegin; }
+  bool isEmpty() const { return mKeys.size() == mBegin; }
+  double key(int index) const { return mKeys.at(mBegin+index); }
+  double value(int index) const { return mValues.at(mBegin+index); }
+  const double *keys() const { return mKeys.constData()+mBegin; }
+  const double *values() const { return mValues.constData()+mBegin; }
+  double firstKey() const { return key(0); }
+  double lastKey() const { return mKeys.last(); }
+  qint64 firstIndex() const { return mFirstIndex; }
+  int revision() const { return mRevision; }
+  
+  // non-property methods:
+  void reserve(int size);
+  void clear();
+  void swap(QCPDataVector &other);
+  void add(double key, double value);
+  void add(const QVector<double> &keys, const QVector<double> &values);
+  void assign(const QVector<double> &keys, const QVector<double> &values);
+  void assign(const QCPDataMap &dataMap);
+  int lowerBound(double key) const;
+  int upperBound(double key) const;
+  void removeBefore(double key);
+  void removeAfter(double key);
+  void remove(double fromKey, double toKey);
+  void remove(double key);
+  void removeFirst(int count);
+  bool valueBounds(int from, int to, double &minValue, double &maxValue, double *mean=0) const;
+  static int reduceValues(const double *values, int count, double &minValue, double &maxValue, double &sum);
+  
+protected:
+  enum { pyramidFanout = 8 }; // number of data points (level 0) or bins (higher levels) summarized by one bin of the next level
+  
+  // min/max/sum of a block of consecutive values, see valueBounds:
+  struct PyramidBin
+  {
+    double min, max, sum;
+    int count;
+  };
+  
+  QVector<double> mKeys, mValues;
+  int mBegin;
+  qint64 mFirstIndex; // running index of the first stored data point, counting all points ever removed from the front
+  int mRevision; // advanced by every modification other than appending or removing from the front
+  
+  // decimation pyramid, built on first use by valueBounds and then kept up to date incrementally:
+  mutable QVector<QVector<PyramidBin> > mLevels; // bins of level l each summarize pyramidFanout^(l+1) data points
+  mutable QVector<qint64> mLevelFirst; // running bin index of the first stored bin per level
+  mutable bool mPyramidValid;
+  
+  void insert(double key, double value);
+  void erase(int from, int to);
+  void compact();
+  void invalidatePyramid();
+  void buildPyramid() const;
+  void updatePyramid(double value);
+  void trimPyramid();
+  static void accumulate(PyramidBin &bin, double value);
+  static void accumulate(PyramidBin &bin, const PyramidBin &other);
+  static void accumulate(PyramidBin &bin, const double *values, int count);
+};
+
+
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable
 {
   Q_OBJECT
@@ -2524,12 +2725,23 @@ public:
                    ,etBoth  ///< Error bars for both key and value dimensions of the data point are shown
                  };
   Q_ENUMS(ErrorType)
+  /*!
+    Defines which container holds the graph's data points
+    \see setDataBackend
+  */
+  enum DataBackend { dbMap    ///< Data is stored in a \ref QCPDataMap (default), supports error bars and arbitrary insertion order
+                     ,dbVector ///< Data is stored in a contiguous \ref QCPDataVector, optimized for appending monotonically increasing keys. Error bars are not stored.
+                   };
+  Q_ENUMS(DataBackend)
   
   explicit QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
   virtual ~QCPGraph();
   
   // getters:
   QCPDataMap *data() const { return mData; }
+  QCPDataVector *dataVector() const { return mDataVector; }
+  DataBackend dataBackend() const { return mDataBackend; }
+  int dataCount() const { return mDataBackend == dbVector ? mDataVector->size() : mData->size(); }
   LineStyle lineStyle() const { return mLineStyle; }
   QCPScatterStyle scatterStyle() const { return mScatterStyle; }
   ErrorType errorType() const { return mErrorType; }
@@ -2556,6 +2768,7 @@ public:
   void setErrorBarSkipSymbol(bool enabled);
   void setChannelFillGraph(QCPGraph *targetGraph);
   void setAdaptiveSampling(bool enabled);
+  void setDataBackend(DataBackend backend);
   
   // non-property methods:
   void addData(const QCPDataMap &dataMap);
@@ -2580,6 +2793,8 @@ public:
 protected:
   // property members:
   QCPDataMap *mData;
+  QCPDataVector *mDataVector;
+  DataBackend mDataBackend;
   QPen mErrorPen;
   LineStyle mLineStyle;
   QCPScatterStyle mScatterStyle;
@@ -2589,8 +2804,20 @@ protected:
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
   
+  // non-property members:
+  qint64 mIncrementBegin, mIncrementEnd; // running data vector indices of the first and one past the last point on the layer buffer, see drawIncrement
+  int mIncrementRevision;
+  mutable QVector<QPointF> mHitTestPixels; // pixel representation of the last drawn frame, see buildHitTestIndex
+  mutable QVector<int> mHitTestFirst, mHitTestLast; // per key pixel column: first and last index of the points/segments reaching into it
+  mutable double mHitTestOrigin; // key pixel coordinate of the first column
+  mutable qint64 mHitTestEnd; // running data vector index one past the last point in mHitTestPixels, or -1, see extendHitTestIndex
+  mutable LineStyle mHitTestLineStyle;
+  mutable bool mHitTestValid;
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
+  virtual bool drawIncrement(QCPPainter *painter);
+  virtual void setIncrementBase();
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const;
   virtual QCPRange getKeyRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
   virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
@@ -2605,6 +2832,8 @@ protected:
   
   // non-virtual methods:
   void getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *scatterData) const;
+  void getPreparedVectorData(QVector<QCPData> *lineData, QVector<QCPData> *scatterData) const;
+  void getSampledVectorLineData(QVector<QCPData> *lineData, int lower, int upperEnd) const;
   void getPlotData(QVector<QPointF> *lineData, QVector<QCPData> *scatterData) const;
   void getScatterPlotData(QVector<QCPData> *scatterData) const;
   void getLinePlotData(QVector<QPointF> *linePixelData, QVector<QCPData> *scatterData) const;
@@ -2612,9 +2841,14 @@ protected:
   void getStepRightPlotData(QVector<QPointF> *linePixelData, QVector<QCPData> *scatterData) const;
   void getStepCenterPlotData(QVector<QPointF> *linePixelData, QVector<QCPData> *scatterData) const;
   void getImpulsePlotData(QVector<QPointF> *linePixelData, QVector<QCPData> *scatterData) const;
+  void dataToPixels(const QVector<QCPData> &data, QPointF *pixels) const;
+  void buildHitTestIndex() const;
+  void extendHitTestIndex(qint64 begin, qint64 end, const QVector<QPointF> &pixels);
+  void indexHitTestSegments(int begin) const;
   void drawError(QCPPainter *painter, double x, double y, const QCPData &data) const;
   void getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMap::const_iterator &upper) const;
   int countDataInBounds(const QCPDataMap::const_iterator &lower, const QCPDataMap::const_iterator &upper, int maxCount) const;
+  void getVisibleDataBounds(int &lower, int &upper) const;
   void addFillBasePoints(QVector<QPointF> *lineData) const;
   void removeFillBasePoints(QVector<QPointF> *lineData) const;
   QPointF lowerFillBasePoint(double lowerKey) const;
@@ -3708,6 +3942,7 @@ protected:
   // non-virtual methods:
   QPen mainPen() const;
   QBrush mainBrush() const;
+  void updateVectorPosition();
 };
 
 
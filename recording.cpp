@@ -0,0 +1,237 @@
+#include "recording.h"
+
+#include <QDataStream>
+#include <QDateTime>
+
+#include <cstddef>
+#include <cstring>
+
+static const char recordingMagic[8] = { 'T', 'S', 'R', 'E', 'C', 'O', 'R', 'D' };
+static const quint32 byteOrderMark = 0x01020304;
+
+static_assert(sizeof(Sample) == 24 && offsetof(Sample, value) == 8 && offsetof(Sample, port) == 16
+              && offsetof(Sample, column) == 18, "recording format depends on the layout of Sample");
+
+/**
+ * @brief 构造函数。
+ * @param parent 父对象指针。
+ */
+RecordingWriter::RecordingWriter(QObject *parent)
+    : QObject(parent)
+{
+}
+
+/**
+ * @brief 析构函数，写完剩余数据并关闭文件。
+ */
+RecordingWriter::~RecordingWriter()
+{
+    stop();
+}
+
+/**
+ * @brief 创建录制文件并写入文件头，之后定时写入采样点。
+ * @param fileName 文件名，已存在则覆盖。
+ * @param p 当前串口配置，保存在文件头中。
+ * @param buffers 各串口的录制缓冲区，本对象为唯一消费者。
+ */
+void RecordingWriter::start(const QString &fileName, const SerialSettings &p,
+                            const QVector<SpscRingBuffer<Sample> *> &buffers)
+{
+    stop();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        emit errorOccurred(m_file.errorString());
+        return;
+    }
+
+    // 串口名个数和长度不定，先写出串口配置，再按实际长度确定文件头长度
+    QByteArray body;
+    QDataStream bodyOut(&body, QIODevice::WriteOnly);
+    bodyOut << QDateTime::currentMSecsSinceEpoch();
+    bodyOut << p.name << qint32(p.baudRate) << qint32(p.dataBits) << qint32(p.parity)
+            << qint32(p.stopBits) << qint32(p.flowControl) << p.portNames;
+
+    const int fixedSize = int(sizeof(recordingMagic) + 3 * sizeof(quint32));
+    const int headerSize = (fixedSize + body.size() + RECORDING_HEADER_ALIGN - 1)
+            / RECORDING_HEADER_ALIGN * RECORDING_HEADER_ALIGN;
+    if (headerSize > RECORDING_HEADER_MAX) {
+        m_file.close();
+        m_file.remove();
+        emit errorOccurred(tr("Too many serial ports to record"));
+        return;
+    }
+
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.writeRawData(recordingMagic, sizeof(recordingMagic));
+    out << quint32(RECORDING_VERSION);
+    out.writeRawData(reinterpret_cast<const char *>(&byteOrderMark), sizeof(byteOrderMark));
+    out << quint32(headerSize);
+    out.writeRawData(body.constData(), body.size());
+    header.append(QByteArray(headerSize - header.size(), '\0'));
+    if (m_file.write(header) != header.size()) {
+        emit errorOccurred(m_file.errorString());
+        m_file.close();
+        return;
+    }
+
+    // 丢弃开始录制之前残留的数据
+    m_buffers = buffers;
+    for (SpscRingBuffer<Sample> *buffer : m_buffers)
+        buffer->drain([](const Sample &) {});
+    m_written.store(0, std::memory_order_relaxed);
+
+    if (!m_timer) {
+        m_timer = new QTimer(this);
+        m_timer->setInterval(RECORD_FLUSH_INTERVAL);
+        connect(m_timer, &QTimer::timeout, this, &RecordingWriter::flush);
+    }
+    m_timer->start();
+}
+
+/**
+ * @brief 停止录制，写完缓冲区中剩余的数据。
+ */
+void RecordingWriter::stop()
+{
+    if (m_timer)
+        m_timer->stop();
+    if (m_file.isOpen()) {
+        flush();
+        m_file.close();
+    }
+    m_buffers.clear();
+}
+
+/**
+ * @brief 取出各录制缓冲区中的全部采样点，一次写入文件。
+ */
+void RecordingWriter::flush()
+{
+    m_chunk.resize(0);
+    std::size_t n = 0;
+    for (SpscRingBuffer<Sample> *buffer : m_buffers)
+        n += buffer->drain([this](const Sample &s) {
+            // 逐字段拷贝，结构体末尾的填充字节写为0，不把内存中残留的数据写入文件
+            char record[sizeof(Sample)] = {};
+            memcpy(record + offsetof(Sample, time), &s.time, sizeof(s.time));
+            memcpy(record + offsetof(Sample, value), &s.value, sizeof(s.value));
+            memcpy(record + offsetof(Sample, port), &s.port, sizeof(s.port));
+            memcpy(record + offsetof(Sample, column), &s.column, sizeof(s.column));
+            m_chunk.append(record, sizeof(record));
+        });
+    if (n == 0)
+        return;
+
+    if (m_file.write(m_chunk) != m_chunk.size()) {
+        emit errorOccurred(m_file.errorString());
+        stop();
+        return;
+    }
+    m_file.flush();
+    m_written.fetch_add(n, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 析构函数，解除映射并关闭文件。
+ */
+RecordingFile::~RecordingFile()
+{
+    close();
+}
+
+/**
+ * @brief 判断文件是否为录制文件（以魔数开头），不检查版本和文件头的其余部分。
+ */
+bool RecordingFile::isRecording(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    return file.read(sizeof(recordingMagic)) == QByteArray(recordingMagic, sizeof(recordingMagic));
+}
+
+/**
+ * @brief 打开录制文件，检查文件头并映射采样数据区。
+ * @param fileName 文件名。
+ * @param errorString 失败时写入原因，可为nullptr。
+ * @return 成功返回true。
+ */
+bool RecordingFile::open(const QString &fileName, QString *errorString)
+{
+    close();
+
+    auto fail = [&](const QString &message) {
+        if (errorString)
+            *errorString = message;
+        close();
+        return false;
+    };
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return fail(m_file.errorString());
+
+    const int fixedSize = int(sizeof(recordingMagic) + 3 * sizeof(quint32));
+    QByteArray header = m_file.read(fixedSize);
+    if (header.size() < fixedSize)
+        return fail(QObject::tr("File is too short for a recording"));
+    QDataStream in(header);
+    char magic[sizeof(recordingMagic)];
+    quint32 version = 0;
+    quint32 byteOrder = 0;
+    quint32 headerSize = 0;
+    in.readRawData(magic, sizeof(magic));
+    in >> version;
+    in.readRawData(reinterpret_cast<char *>(&byteOrder), sizeof(byteOrder));
+    in >> headerSize;
+    if (memcmp(magic, recordingMagic, sizeof(magic)) != 0)
+        return fail(QObject::tr("Not a recording file"));
+    if (version != RECORDING_VERSION)
+        return fail(QObject::tr("Unsupported recording version %1").arg(version));
+    if (byteOrder != byteOrderMark)
+        return fail(QObject::tr("Recording was written with a different byte order"));
+    if (headerSize < quint32(fixedSize) || headerSize > RECORDING_HEADER_MAX
+            || headerSize % RECORDING_HEADER_ALIGN != 0 || m_file.size() < qint64(headerSize))
+        return fail(QObject::tr("Corrupt recording header"));
+
+    header = m_file.read(headerSize - fixedSize);
+    QDataStream settingsIn(header);
+    qint32 baudRate, dataBits, parity, stopBits, flowControl;
+    settingsIn >> m_startTime >> m_settings.name >> baudRate >> dataBits >> parity >> stopBits >> flowControl
+               >> m_settings.portNames;
+    if (settingsIn.status() != QDataStream::Ok)
+        return fail(QObject::tr("Corrupt recording header"));
+    m_settings.baudRate = baudRate;
+    m_settings.stringBaudRate = QString::number(baudRate);
+    m_settings.dataBits = static_cast<QSerialPort::DataBits>(dataBits);
+    m_settings.parity = static_cast<QSerialPort::Parity>(parity);
+    m_settings.stopBits = static_cast<QSerialPort::StopBits>(stopBits);
+    m_settings.flowControl = static_cast<QSerialPort::FlowControl>(flowControl);
+
+    m_count = (m_file.size() - headerSize) / qint64(sizeof(Sample));
+    if (m_count == 0)
+        return true;
+
+    m_map = m_file.map(headerSize, m_count * qint64(sizeof(Sample)));
+    if (!m_map)
+        return fail(m_file.errorString());
+    m_samples = reinterpret_cast<const Sample *>(m_map);
+    return true;
+}
+
+/**
+ * @brief 解除映射并关闭文件。
+ */
+void RecordingFile::close()
+{
+    if (m_map)
+        m_file.unmap(m_map);
+    m_map = nullptr;
+    m_samples = nullptr;
+    m_count = 0;
+    if (m_file.isOpen())
+        m_file.close();
+}
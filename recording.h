@@ -0,0 +1,99 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <QObject>
+#include <QFile>
+#include <QTimer>
+#include <QVector>
+
+#include <atomic>
+
+#include "serialsettings.h"
+#include "ringbuffer.h"
+#include "sample.h"
+
+/*
+ * 录制文件格式（只追加）：
+ *   [0, 文件头长度)  文件头，QDataStream写入，长度随串口名变化，补0到RECORDING_HEADER_ALIGN的整数倍
+ *       char[8]  魔数 "TSRECORD"
+ *       quint32  版本号
+ *       quint32  字节序标记（本机字节序写入的0x01020304）
+ *       quint32  文件头长度（含补齐的0）
+ *       qint64   开始时间（ms since epoch）
+ *       串口配置：端口名、波特率、数据位、校验、停止位、流控、全部串口名
+ *   之后每个采样点为一个Sample结构（本机字节序与内存布局，共24字节）：
+ *       double time @0，double value @8，quint16 port @16，quint16 column @18，4字节填充 @20（写为0）
+ * 采样点定长连续存放，可直接内存映射后当作Sample数组访问；
+ * 多个串口的数据交错存放，同一串口的数据按时间递增；
+ * 程序异常退出时末尾不完整的采样点会被忽略。
+ */
+#define RECORDING_HEADER_ALIGN 256     // 文件头长度的对齐单位，使采样点数组按8字节对齐
+#define RECORDING_HEADER_MAX 65536      // 打开文件时允许的最大文件头长度
+#define RECORDING_VERSION 4
+#define RECORD_FLUSH_INTERVAL 100   // 写盘周期（毫秒）
+
+/**
+ * @brief 录制写入类，运行在独立的写盘线程中。
+ *
+ * 各读取线程把采样点写入各自的录制缓冲区，本类定时取出并追加写入文件。
+ */
+class RecordingWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RecordingWriter(QObject *parent = nullptr);
+    ~RecordingWriter();
+
+    quint64 writtenSamples() const { return m_written.load(std::memory_order_relaxed); }
+
+public slots:
+    void start(const QString &fileName, const SerialSettings &p,
+               const QVector<SpscRingBuffer<Sample> *> &buffers);   // 开始录制（须在写盘线程中调用）
+    void stop();                                                            // 停止录制（须在写盘线程中调用）
+
+signals:
+    void errorOccurred(const QString &message);
+
+private:
+    void flush();   // 取出缓冲区中的数据并写入文件
+
+    QVector<SpscRingBuffer<Sample> *> m_buffers;    // 录制缓冲区（消费者端）
+    QFile                   m_file;
+    QTimer                  *m_timer = nullptr; // 写盘定时器，在写盘线程中创建
+    QByteArray              m_chunk;            // 写盘缓存，重复使用
+
+    std::atomic<quint64>    m_written{0};       // 已写入的采样点数
+};
+
+/**
+ * @brief 录制文件读取类，以内存映射方式打开，不解析、不拷贝采样数据。
+ */
+class RecordingFile
+{
+public:
+    RecordingFile() = default;
+    ~RecordingFile();
+
+    RecordingFile(const RecordingFile &) = delete;
+    RecordingFile &operator=(const RecordingFile &) = delete;
+
+    static bool isRecording(const QString &fileName);
+    bool open(const QString &fileName, QString *errorString = nullptr);
+    void close();
+
+    const SerialSettings &settings() const { return m_settings; }           // 录制时的串口配置
+    qint64 startTime() const { return m_startTime; }                        // 开始时间（ms since epoch）
+    qint64 count() const { return m_count; }                                // 采样点个数
+    const Sample *samples() const { return m_samples; }                     // 映射区中的采样点数组
+
+private:
+    QFile                       m_file;
+    uchar                       *m_map = nullptr;
+    const Sample                *m_samples = nullptr;
+    qint64                      m_count = 0;
+    qint64                      m_startTime = 0;
+    SerialSettings              m_settings{};
+};
+
+#endif // RECORDING_H
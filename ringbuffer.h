@@ -0,0 +1,80 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief 单生产者/单消费者无锁环形缓冲区。
+ *
+ * 仅允许一个线程调用 push()，另一个线程调用 pop()/drain()。
+ * 容量向上取整为2的幂，满时 push() 返回false而不是阻塞。
+ */
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(std::size_t capacity)
+    {
+        std::size_t n = 2;
+        while (n < capacity)
+            n <<= 1;
+        m_buffer.resize(n);
+        m_mask = n - 1;
+    }
+
+    SpscRingBuffer(const SpscRingBuffer &) = delete;
+    SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+    /* 生产者端 */
+    bool push(const T &item)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) > m_mask)
+            return false;   // 已满
+        m_buffer[head & m_mask] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* 消费者端 */
+    bool pop(T &item)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+            return false;   // 为空
+        item = m_buffer[tail & m_mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* 消费者端：一次取出当前所有元素，逐个交给func处理，返回取出个数 */
+    template <typename Func>
+    std::size_t drain(Func func)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        for (std::size_t i = tail; i != head; ++i)
+            func(m_buffer[i & m_mask]);
+        m_tail.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    /* 近似值，任意线程均可调用 */
+    std::size_t size() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+    std::vector<T> m_buffer;
+    std::size_t m_mask;
+
+    alignas(64) std::atomic<std::size_t> m_head{0};  // 写位置（生产者）
+    alignas(64) std::atomic<std::size_t> m_tail{0};  // 读位置（消费者）
+};
+
+#endif // RINGBUFFER_H
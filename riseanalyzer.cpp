@@ -0,0 +1,162 @@
+#include "riseanalyzer.h"
+
+#include <algorithm>
+
+/**
+ * @brief 构造函数。
+ * @param window 稳态均值窗口长度（点数）。
+ * @param threshold 上升判定阈值。
+ */
+RiseAnalyzer::RiseAnalyzer(std::size_t window, double threshold)
+    : m_window(std::max<std::size_t>(window, 1)), m_threshold(threshold)
+{
+    m_history.resize(m_window);
+    reset();
+}
+
+/**
+ * @brief 清空所有状态。
+ */
+void RiseAnalyzer::reset()
+{
+    m_next = 0;
+    m_filled = 0;
+    m_sum = 0;
+    m_rising = false;
+    m_settled = false;
+    m_sinceRise = 0;
+    m_lastMean = 0;
+    m_baseline = 0;
+    m_riseStart = 0;
+    m_records.clear();
+}
+
+/**
+ * @brief 输入一个采样点并更新统计量。
+ * @param time 采样时间。
+ * @param value 采样值。
+ */
+void RiseAnalyzer::addSample(double time, double value)
+{
+    // 至少积累四分之一窗口后才开始判定，避免开头几个点的噪声误判
+    if (!m_rising && m_filled >= (m_window + 3) / 4 && value > windowMean() + m_threshold)
+    {
+        m_rising = true;
+        m_baseline = windowMean();
+        m_lastMean = m_baseline;
+        m_riseStart = time;
+
+        // 10%的位置可能低于判定阈值，从窗口中最后一个不高于稳态值的点之后开始记录
+        std::size_t start = m_filled;
+        for (std::size_t i = 0; i < m_filled; ++i)
+        {
+            const Sample &s = m_history[(m_next + m_window - 1 - i) % m_window];
+            if (s.value <= m_baseline)
+            {
+                start = i;
+                break;
+            }
+        }
+        for (std::size_t i = start; i-- > 0; )
+        {
+            const Sample &s = m_history[(m_next + m_window - 1 - i) % m_window];
+            if (m_records.empty() || s.value > m_records.back().value)
+                m_records.push_back(s);
+        }
+    }
+
+    if (m_rising && !m_settled && (m_records.empty() || value > m_records.back().value))
+    {
+        if (m_records.size() >= ANALYZER_MAX_RECORDS)
+        {
+            // 隔点抽稀，保留首尾，穿越时间的分辨率减半
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i + 1 < m_records.size(); i += 2)
+                m_records[kept++] = m_records[i];
+            m_records[kept++] = m_records.back();
+            m_records.resize(kept);
+        }
+        m_records.push_back(Sample{time, value});
+    }
+    if (m_rising && m_sinceRise < m_window)
+        ++m_sinceRise;
+
+    // 更新滑动窗口
+    if (m_filled == m_window)
+        m_sum -= m_history[m_next].value;
+    else
+        ++m_filled;
+    m_history[m_next] = Sample{time, value};
+    m_sum += value;
+    m_next = (m_next + 1) % m_window;
+
+    // 每转一圈重新求和一次，消除浮点累计误差，均摊O(1)
+    if (m_next == 0)
+    {
+        m_sum = 0;
+        for (std::size_t i = 0; i < m_filled; ++i)
+            m_sum += m_history[i].value;
+
+        // 窗口内全是上升后的点、均值一圈内变化小于阈值且记录点已超过均值：已到达平台，
+        // 之后的新高点不影响穿越时间；均值再次变化或超出记录点时恢复记录
+        if (m_rising && m_sinceRise >= m_window)
+        {
+            const double mean = windowMean();
+            m_settled = mean - m_lastMean < m_threshold && m_lastMean - mean < m_threshold
+                    && !m_records.empty() && m_records.back().value >= mean;
+            m_lastMean = mean;
+        }
+    }
+}
+
+/**
+ * @brief 上升前稳态值：未检测到上升时为当前滑动均值。
+ */
+double RiseAnalyzer::beforeRise() const
+{
+    return m_rising ? m_baseline : windowMean();
+}
+
+/**
+ * @brief 上升后稳态值：最近窗口内的滑动均值。
+ */
+double RiseAnalyzer::afterRise() const
+{
+    return windowMean();
+}
+
+/**
+ * @brief 按当前的上升前后稳态值计算10%~90%上升时间。
+ * @return 上升时间；未检测到上升或尚未到达90%时返回0。
+ */
+double RiseAnalyzer::riseTime() const
+{
+    if (!m_rising)
+        return 0;
+
+    const double step = afterRise() - m_baseline;
+    if (step <= 0)
+        return 0;
+
+    const double t10 = crossingTime(m_baseline + 0.1 * step);
+    const double t90 = crossingTime(m_baseline + 0.9 * step);
+    if (t10 < 0 || t90 < 0)
+        return 0;
+    return t90 - t10;
+}
+
+double RiseAnalyzer::windowMean() const
+{
+    return m_filled ? m_sum / m_filled : 0;
+}
+
+/**
+ * @brief 查找信号首次达到level的时间，记录点数值递增，二分查找。
+ * @return 穿越时间；尚未达到时返回-1。
+ */
+double RiseAnalyzer::crossingTime(double level) const
+{
+    auto it = std::lower_bound(m_records.begin(), m_records.end(), level,
+                               [](const Sample &s, double v) { return s.value < v; });
+    return it == m_records.end() ? -1 : it->time;
+}
@@ -0,0 +1,61 @@
+#ifndef RISEANALYZER_H
+#define RISEANALYZER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "sample.h"
+
+#define ANALYZER_WINDOW 50  // 稳态均值窗口（点数）
+#define RISE_THRESHOLD 0.3  // 超过上升前稳态该值即认为开始上升
+#define ANALYZER_MAX_RECORDS 4096   // 穿越时间记录点的上限，超过时隔点抽稀
+
+/**
+ * @brief 流式稳态值与上升时间分析器。
+ *
+ * 每个采样点均摊O(1)更新，内存有上限，不保存完整历史，可用于无界数据流和无界面程序：
+ * - 上升前稳态：检测到上升之前最近N个点的均值，检测到上升时冻结；
+ * - 上升后稳态：最近N个点的滑动均值；
+ * - 上升开始：首个超过上升前稳态+阈值的点；
+ * - 上升时间：信号从10%到90%阶跃幅度所用的时间。
+ * 上升后滑动均值在一个窗口内的变化小于阈值、且记录点已超过均值时认为已稳定，稳定期间不记录新高点；
+ * 一直不稳定（如持续漂移）时记录点达到ANALYZER_MAX_RECORDS后隔点抽稀。
+ */
+class RiseAnalyzer
+{
+public:
+    explicit RiseAnalyzer(std::size_t window = ANALYZER_WINDOW, double threshold = RISE_THRESHOLD);
+
+    void reset();                           // 清空状态，开始新的测量
+    void addSample(double time, double value);
+
+    bool riseDetected() const { return m_rising; }
+    bool hasData() const { return m_filled > 0; }
+    double beforeRise() const;              // 上升前稳态值
+    double afterRise() const;               // 上升后稳态值（当前滑动均值）
+    double riseStartTime() const { return m_riseStart; }
+    double riseTime() const;                // 10%~90%上升时间，尚未到达90%时返回0
+
+private:
+    double windowMean() const;
+    double crossingTime(double level) const;
+
+    std::size_t         m_window;       // 窗口长度
+    double              m_threshold;    // 上升判定阈值
+
+    std::vector<Sample> m_history;      // 最近m_window个点（环形）
+    std::size_t         m_next;         // 下一个写入位置
+    std::size_t         m_filled;       // 已写入个数（不超过m_window）
+    double              m_sum;          // 窗口内数值之和
+
+    bool                m_rising;       // 已检测到上升
+    bool                m_settled;      // 上升后已稳定，暂停记录新高点
+    std::size_t         m_sinceRise;    // 检测到上升后的点数（达到m_window后不再增加）
+    double              m_lastMean;     // 上次稳定性检查时的滑动均值
+    double              m_baseline;     // 冻结的上升前稳态值
+    double              m_riseStart;    // 上升开始时间
+
+    std::vector<Sample> m_records;      // 上升后每次创新高的点，数值严格递增，用于查找穿越时间，最多ANALYZER_MAX_RECORDS个
+};
+
+#endif // RISEANALYZER_H
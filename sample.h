@@ -0,0 +1,15 @@
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <cstdint>
+
+/* 单个带时间戳的采样点 */
+struct Sample
+{
+    double time;            // 时间（秒）
+    double value;           // 数值
+    std::uint16_t port;     // 来源串口序号
+    std::uint16_t column;   // 帧内列号（多探头时每列一个通道）
+};
+
+#endif // SAMPLE_H
@@ -0,0 +1,239 @@
+#include "sampledecoder.h"
+
+#include <limits>
+
+namespace {
+
+const double powersOf10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+inline bool isSeparator(char c)
+{
+    return c == ',' || c == ';' || c == '\t' || c == ' ';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/* 计算 10^exp，|exp| 较大时逐段相乘 */
+double scale(double value, int exp)
+{
+    while (exp > 22) {
+        value *= 1e22;
+        exp -= 22;
+    }
+    while (exp < -22) {
+        value /= 1e22;
+        exp += 22;
+    }
+    return exp >= 0 ? value * powersOf10[exp] : value / powersOf10[-exp];
+}
+
+} // namespace
+
+/**
+ * @brief 构造函数。
+ */
+SampleDecoder::SampleDecoder()
+    : m_length(0), m_overflow(false), m_errors(0), m_deviceTimestamps(false)
+{
+}
+
+/**
+ * @brief 输入一段字节流并解析其中所有完整的帧。
+ * @param data 字节流起始地址。
+ * @param size 字节数。
+ * @param out 输出数组，解析出的采样点追加在末尾。
+ * @return 本次解析出的采样点个数。
+ */
+std::size_t SampleDecoder::feed(const char *data, std::size_t size, std::vector<Sample> &out)
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        const char c = data[i];
+        if (c == '\n' || c == '\r')
+        {
+            finishFrame(out, count);
+            continue;
+        }
+        if (m_length < DECODER_MAX_FRAME)
+            m_frame[m_length++] = c;
+        else
+            m_overflow = true;
+    }
+    return count;
+}
+
+/**
+ * @brief 丢弃未结束的帧并清零错误计数。
+ */
+void SampleDecoder::reset()
+{
+    m_length = 0;
+    m_overflow = false;
+    m_errors = 0;
+}
+
+/**
+ * @brief 结束当前帧，解析成功则追加到输出中。空帧（如"\r\n"）直接忽略。
+ */
+void SampleDecoder::finishFrame(std::vector<Sample> &out, std::size_t &count)
+{
+    if (m_overflow)
+    {
+        ++m_errors;
+    }
+    else if (m_length > 0)
+    {
+        const std::size_t n = parseFrame(m_frame, m_frame + m_length, out);
+        if (n > 0)
+            count += n;
+        else
+            ++m_errors;
+    }
+    m_length = 0;
+    m_overflow = false;
+}
+
+/**
+ * @brief 解析一帧："数值1,数值2,..."，开启设备时间戳时为"时间,数值1,数值2,..."。
+ *
+ * 单次扫描，逐列直接解析为double，不拷贝字段。
+ * @param begin 帧起始地址。
+ * @param end 帧结束地址（不含）。
+ * @param out 输出数组，成功时追加本帧各列的采样点，未带时间戳时time为NaN。
+ * @return 追加的采样点个数，解析失败返回0且不修改out。
+ */
+std::size_t SampleDecoder::parseFrame(const char *begin, const char *end, std::vector<Sample> &out) const
+{
+    const std::size_t first = out.size();
+    Sample sample = Sample();
+    sample.time = std::numeric_limits<double>::quiet_NaN();
+    bool needTime = m_deviceTimestamps;
+
+    const char *p = begin;
+    while (p < end && *p == ' ')
+        ++p;
+    while (p < end)
+    {
+        const char *field = p;
+        while (p < end && !isSeparator(*p))
+            ++p;
+
+        double value;
+        if (!parseNumber(field, p, value) || sample.column >= DECODER_MAX_COLUMNS)
+        {
+            out.resize(first);
+            return 0;
+        }
+        if (needTime)
+        {
+            sample.time = value;
+            needTime = false;
+        }
+        else
+        {
+            sample.value = value;
+            out.push_back(sample);
+            ++sample.column;
+        }
+
+        // 连续空格视为一个分隔符，','、';'、制表符两侧允许有空格，允许行尾多一个分隔符
+        while (p < end && *p == ' ')
+            ++p;
+        if (p < end && *p != ' ' && isSeparator(*p))
+            ++p;
+        while (p < end && *p == ' ')
+            ++p;
+    }
+    return out.size() - first;
+}
+
+/**
+ * @brief 解析十进制浮点数，格式为 [+-]digits[.digits][(e|E)[+-]digits]。
+ * @param begin 起始地址。
+ * @param end 结束地址（不含）。
+ * @param value 解析结果。
+ * @return 整段（除首尾空白外）均为合法数字时返回true。
+ */
+bool SampleDecoder::parseNumber(const char *begin, const char *end, double &value)
+{
+    while (begin < end && isSpace(*begin))
+        ++begin;
+    while (end > begin && isSpace(*(end - 1)))
+        --end;
+
+    const char *p = begin;
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-'))
+        negative = (*p++ == '-');
+
+    std::uint64_t mantissa = 0;
+    int digits = 0;     // 已计入尾数的有效位数
+    int exp10 = 0;
+    bool any = false;
+
+    for (; p < end && isDigit(*p); ++p)
+    {
+        any = true;
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+            if (mantissa)
+                ++digits;
+        }
+        else
+        {
+            ++exp10;    // 超出精度的整数位只影响数量级
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && isDigit(*p); ++p)
+        {
+            any = true;
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+                if (mantissa)
+                    ++digits;
+                --exp10;
+            }
+        }
+    }
+    if (!any)
+        return false;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool expNegative = false;
+        if (p < end && (*p == '+' || *p == '-'))
+            expNegative = (*p++ == '-');
+        if (p == end || !isDigit(*p))
+            return false;
+        int e = 0;
+        for (; p < end && isDigit(*p); ++p)
+        {
+            if (e < 10000)
+                e = e * 10 + (*p - '0');
+        }
+        exp10 += expNegative ? -e : e;
+    }
+    if (p != end)
+        return false;
+
+    double result = scale(static_cast<double>(mantissa), exp10);
+    value = negative ? -result : result;
+    return true;
+}
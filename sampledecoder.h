@@ -0,0 +1,54 @@
+#ifndef SAMPLEDECODER_H
+#define SAMPLEDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sample.h"
+
+#define DECODER_MAX_FRAME 256   // 单帧最大长度（字节），超长帧整帧丢弃
+#define DECODER_MAX_COLUMNS 64  // 单帧最多列数
+
+/**
+ * @brief 流式采样解码器。
+ *
+ * 串口每次readyRead得到的字节块可能包含多个采样，也可能只有半个，
+ * 解码器在两次调用之间保留未结束的帧，按行分隔符（'\n'、'\r'）切分，
+ * 逐帧解析出数值。解析过程不分配内存。
+ *
+ * 一帧可包含多列数值，如"23.41,24.02,22.98"，列之间以','、';'、制表符或空格分隔，
+ * 每列输出一个采样点，column为列号，同一帧的采样点连续输出且column从0开始。
+ * 开启设备时间戳后第一列为时间，如"时间,数值1,数值2"，
+ * 否则输出采样点的时间为NaN，由调用者打时间戳。
+ * 帧中任意一列解析失败则整帧丢弃。
+ */
+class SampleDecoder
+{
+public:
+    SampleDecoder();
+
+    /* 输入一段字节流，解析出的采样点追加到out中，返回本次解析出的个数 */
+    std::size_t feed(const char *data, std::size_t size, std::vector<Sample> &out);
+    void reset();   // 丢弃未结束的帧并清零计数
+
+    void setDeviceTimestamps(bool enabled) { m_deviceTimestamps = enabled; }
+    bool deviceTimestamps() const { return m_deviceTimestamps; }
+
+    std::uint64_t parseErrors() const { return m_errors; }
+
+    /* 解析[begin, end)中的十进制浮点数，允许首尾空白 */
+    static bool parseNumber(const char *begin, const char *end, double &value);
+
+private:
+    void finishFrame(std::vector<Sample> &out, std::size_t &count);
+    std::size_t parseFrame(const char *begin, const char *end, std::vector<Sample> &out) const;
+
+    char            m_frame[DECODER_MAX_FRAME]; // 未结束的帧
+    std::size_t     m_length;                   // 当前帧长度
+    bool            m_overflow;                 // 当前帧已超长
+    std::uint64_t   m_errors;                   // 解析失败的帧数
+    bool            m_deviceTimestamps;         // 帧中带设备时间戳
+};
+
+#endif // SAMPLEDECODER_H
@@ -0,0 +1,213 @@
+#include "serialreader.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+/**
+ * @brief 构造函数。
+ * @param buffer 采样环形缓冲区，本对象为唯一生产者。
+ * @param port 串口序号，用于区分多个串口的数据。
+ * @param parent 父对象指针。
+ */
+SerialReader::SerialReader(SpscRingBuffer<Sample> *buffer, int port, QObject *parent)
+    : QObject(parent), m_buffer(buffer), m_port(static_cast<std::uint16_t>(port))
+{
+    m_samples.reserve(1024);
+}
+
+/**
+ * @brief 析构函数，关闭串口。
+ */
+SerialReader::~SerialReader()
+{
+    close();
+}
+
+/**
+ * @brief 按给定配置打开串口，串口对象在读取线程中创建。
+ *
+ * 串口名为虚拟串口（见VirtualDevice）时改用合成信号或录制回放。
+ * @param p 串口配置。
+ */
+void SerialReader::open(const SerialSettings &p)
+{
+    close();
+    delete m_virtual;
+    m_virtual = VirtualDevice::create(p, this);
+    if (m_virtual) {
+        connect(m_virtual, &QIODevice::readyRead, this, &SerialReader::readData);
+        m_device = m_virtual;
+    } else {
+        if (!m_serial) {
+            m_serial = new QSerialPort(this);
+            connect(m_serial, &QSerialPort::readyRead, this, &SerialReader::readData);
+        }
+        m_serial->setPortName(p.name);
+        m_serial->setBaudRate(p.baudRate);
+        m_serial->setDataBits(p.dataBits);
+        m_serial->setParity(p.parity);
+        m_serial->setStopBits(p.stopBits);
+        m_serial->setFlowControl(p.flowControl);
+        m_device = m_serial;
+    }
+
+    m_protocol = p.protocol;
+    m_decoder.reset();
+    m_decoder.setDeviceTimestamps(p.deviceTimestamps);
+    m_packetDecoder.reset();
+    m_bytesRead.store(0, std::memory_order_relaxed);
+    m_samplesDecoded.store(0, std::memory_order_relaxed);
+    m_parseErrors.store(0, std::memory_order_relaxed);
+    m_crcErrors.store(0, std::memory_order_relaxed);
+    m_resyncs.store(0, std::memory_order_relaxed);
+    m_stats = TimingStats();
+    m_periodM2 = 0;
+    m_lastTime = qQNaN();
+    publishTimingStats();
+
+    // 每个字符：起始位、数据位、校验位和停止位（1.5位按2位计）
+    const int charBits = 1 + p.dataBits + (p.parity == QSerialPort::NoParity ? 0 : 1)
+            + (p.stopBits == QSerialPort::OneStop ? 1 : 2);
+    m_charNs = p.baudRate > 0 ? charBits * 1e9 / p.baudRate : 0;
+
+    m_clock.start();
+    m_lastReadNs = 0;
+
+    if (!m_device->open(QIODevice::ReadWrite))
+        emit errorOccurred(m_device->errorString());
+}
+
+/**
+ * @brief 关闭串口。
+ */
+void SerialReader::close()
+{
+    if (m_device && m_device->isOpen())
+        m_device->close();
+}
+
+/**
+ * @brief 读取串口数据，解码出所有完整帧，打上时间戳后写入环形缓冲区。
+ */
+void SerialReader::readData()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    const QByteArray d = m_device->readAll();
+
+    m_samples.clear();
+    if (m_protocol == SerialSettings::ProtocolBinary) {
+        m_packetDecoder.feed(d.constData(), static_cast<std::size_t>(d.size()), m_samples);
+        m_parseErrors.store(m_packetDecoder.parseErrors(), std::memory_order_relaxed);
+        m_crcErrors.store(m_packetDecoder.crcErrors(), std::memory_order_relaxed);
+        m_resyncs.store(m_packetDecoder.resyncs(), std::memory_order_relaxed);
+    } else {
+        m_decoder.feed(d.constData(), static_cast<std::size_t>(d.size()), m_samples);
+        m_parseErrors.store(m_decoder.parseErrors(), std::memory_order_relaxed);
+    }
+
+    m_bytesRead.fetch_add(static_cast<quint64>(d.size()), std::memory_order_relaxed);
+    m_samplesDecoded.fetch_add(m_samples.size(), std::memory_order_relaxed);
+
+    // 本次读到的数据在读取之前的传输时间内陆续到达，各帧在这段时间内按帧数均匀分布，
+    // 不早于上次读到完整帧的时刻，也就不会把空闲间隔分摊给突发到达的数据；
+    // 同一帧的各列共用一个时间戳，列号不再递增即视为新的一帧；
+    // 波特率未知时无法估计传输时间，分布在距上次读取的整个间隔内
+    const qint64 window = m_charNs > 0 ? std::min(now - m_lastReadNs, static_cast<qint64>(d.size() * m_charNs))
+                                       : now - m_lastReadNs;
+    const qint64 start = now - window;
+    const std::size_t n = m_samples.size();
+    std::size_t frames = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        if (i == 0 || m_samples[i].column <= m_samples[i - 1].column)
+            ++frames;
+
+    SpscRingBuffer<Sample> *record = m_recordBuffer.load(std::memory_order_acquire);
+    std::size_t frame = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        Sample &s = m_samples[i];
+        s.port = m_port;
+        if (i == 0 || s.column <= m_samples[i - 1].column)
+        {
+            ++frame;
+            if (qIsNaN(s.time))
+                s.time = (start + window * double(frame) / frames) * 1e-9;
+            updateTimingStats(s.time);
+        }
+        else
+        {
+            s.time = m_samples[i - 1].time;
+        }
+
+        if (!m_buffer->push(s))
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        if (record && !record->push(s))
+            m_recordDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (n > 0) {
+        m_lastReadNs = now;
+        publishTimingStats();
+    }
+}
+
+/**
+ * @brief 用Welford算法在线更新采样间隔的均值与方差。
+ * @param t 当前采样点时间。
+ */
+void SerialReader::updateTimingStats(double t)
+{
+    if (qIsNaN(m_lastTime)) {
+        m_lastTime = t;     // 第一个点没有间隔
+        return;
+    }
+
+    const double period = t - m_lastTime;
+    m_lastTime = t;
+
+    ++m_stats.count;
+    const double delta = period - m_stats.meanPeriod;
+    m_stats.meanPeriod += delta / m_stats.count;
+    m_periodM2 += delta * (period - m_stats.meanPeriod);
+    m_stats.jitter = m_stats.count > 1 ? qSqrt(m_periodM2 / (m_stats.count - 1)) : 0;
+    if (m_stats.count == 1 || period < m_stats.minPeriod)
+        m_stats.minPeriod = period;
+    if (m_stats.count == 1 || period > m_stats.maxPeriod)
+        m_stats.maxPeriod = period;
+}
+
+/**
+ * @brief 以序号锁发布采样间隔统计：写入前后各把序号加1，读取方据此判断是否读到了一致的副本。
+ */
+void SerialReader::publishTimingStats()
+{
+    const unsigned seq = m_statsSeq.load(std::memory_order_relaxed);
+    m_statsSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_publishedCount.store(m_stats.count, std::memory_order_relaxed);
+    m_publishedMean.store(m_stats.meanPeriod, std::memory_order_relaxed);
+    m_publishedJitter.store(m_stats.jitter, std::memory_order_relaxed);
+    m_publishedMin.store(m_stats.minPeriod, std::memory_order_relaxed);
+    m_publishedMax.store(m_stats.maxPeriod, std::memory_order_relaxed);
+    m_statsSeq.store(seq + 2, std::memory_order_release);
+}
+
+/**
+ * @brief 获取最近一次读取后发布的采样间隔统计，不加锁，读到写入中途的副本时重读。
+ */
+TimingStats SerialReader::timingStats() const
+{
+    TimingStats stats;
+    unsigned before, after;
+    do {
+        before = m_statsSeq.load(std::memory_order_acquire);
+        stats.count = m_publishedCount.load(std::memory_order_relaxed);
+        stats.meanPeriod = m_publishedMean.load(std::memory_order_relaxed);
+        stats.jitter = m_publishedJitter.load(std::memory_order_relaxed);
+        stats.minPeriod = m_publishedMin.load(std::memory_order_relaxed);
+        stats.maxPeriod = m_publishedMax.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = m_statsSeq.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return stats;
+}
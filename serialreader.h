@@ -0,0 +1,110 @@
+#ifndef SERIALREADER_H
+#define SERIALREADER_H
+
+#include <QObject>
+#include <QSerialPort>
+#include <QElapsedTimer>
+
+#include <atomic>
+#include <vector>
+
+#include "serialsettings.h"
+#include "sampledecoder.h"
+#include "packetdecoder.h"
+#include "virtualdevice.h"
+#include "ringbuffer.h"
+#include "sample.h"
+
+/* 采样间隔统计（秒） */
+struct TimingStats
+{
+    quint64 count = 0;      // 统计的间隔个数
+    double meanPeriod = 0;  // 平均采样间隔
+    double jitter = 0;      // 采样间隔标准差
+    double minPeriod = 0;   // 最小采样间隔
+    double maxPeriod = 0;   // 最大采样间隔
+};
+
+/**
+ * @brief 串口采集类，运行在独立的读取线程中。
+ *
+ * 持有串口对象，解析收到的数据并把带时间戳的采样点写入环形缓冲区，
+ * GUI线程按自己的节奏从缓冲区取数据，互不阻塞。
+ *
+ * 按配置使用文本解码器或二进制数据包解码器。
+ * 时间戳取自单调时钟（开始采集时为0）。一次读到多个采样点时，
+ * 在按波特率算出的本次数据传输时间内按帧均匀分布（同一帧的各列时间相同），
+ * 不跨越两次读取之间的空闲间隔；若帧中带设备时间戳则直接使用。
+ *
+ * 采样间隔统计只在读取线程中更新，每次读取后以序号锁（seqlock）发布一份副本，
+ * 其他线程读取时不加锁、不阻塞读取线程。
+ */
+class SerialReader : public QObject
+{
+    Q_OBJECT
+
+public:
+    SerialReader(SpscRingBuffer<Sample> *buffer, int port, QObject *parent = nullptr);
+    ~SerialReader();
+
+    quint64 bytesRead() const { return m_bytesRead.load(std::memory_order_relaxed); }
+    quint64 samplesDecoded() const { return m_samplesDecoded.load(std::memory_order_relaxed); }
+    quint64 droppedSamples() const { return m_dropped.load(std::memory_order_relaxed); }
+    quint64 recordDroppedSamples() const { return m_recordDropped.load(std::memory_order_relaxed); }
+    quint64 parseErrors() const { return m_parseErrors.load(std::memory_order_relaxed); }
+    quint64 crcErrors() const { return m_crcErrors.load(std::memory_order_relaxed); }
+    quint64 resyncs() const { return m_resyncs.load(std::memory_order_relaxed); }
+    TimingStats timingStats() const;    // 可在任意线程调用
+
+    /* 设置录制缓冲区，nullptr表示不录制；可在任意线程调用 */
+    void setRecordBuffer(SpscRingBuffer<Sample> *buffer) { m_recordBuffer.store(buffer, std::memory_order_release); }
+
+public slots:
+    void open(const SerialSettings &p);             // 开启串口（须在读取线程中调用）
+    void close();                                   // 关闭串口（须在读取线程中调用）
+
+signals:
+    void errorOccurred(const QString &message);     // 串口错误
+
+private:
+    void readData();                // 读取数据
+    void updateTimingStats(double t);   // 统计采样间隔
+    void publishTimingStats();          // 发布采样间隔统计的副本
+
+    SpscRingBuffer<Sample>  *m_buffer;          // 采样缓冲区（生产者端）
+    const std::uint16_t     m_port;             // 串口序号，写入每个采样点
+    std::atomic<SpscRingBuffer<Sample> *> m_recordBuffer{nullptr};  // 录制缓冲区（生产者端）
+    QSerialPort             *m_serial = nullptr;// 串口类
+    VirtualDevice           *m_virtual = nullptr;// 虚拟串口
+    QIODevice               *m_device = nullptr;// 当前使用的设备（m_serial或m_virtual）
+    SampleDecoder           m_decoder;          // 文本解码器
+    PacketDecoder           m_packetDecoder;    // 二进制数据包解码器
+    SerialSettings::Protocol m_protocol = SerialSettings::ProtocolText;
+    std::vector<Sample>     m_samples;          // 解码输出，重复使用避免分配
+
+    QElapsedTimer   m_clock;            // 单调时钟，打开串口时启动
+    qint64          m_lastReadNs = 0;   // 上次读到完整帧的时刻（纳秒）
+    double          m_charNs = 0;       // 按波特率传输一个字符的时间（纳秒），0表示未知
+    double          m_lastTime = 0;     // 上一个采样点的时间，NaN表示还没有
+
+    TimingStats     m_stats;            // 采样间隔统计（仅读取线程访问）
+    double          m_periodM2 = 0;     // Welford算法的二阶累计量
+
+    /* 发布的统计副本：序号为奇数时正在写入 */
+    std::atomic<unsigned>   m_statsSeq{0};
+    std::atomic<quint64>    m_publishedCount{0};
+    std::atomic<double>     m_publishedMean{0};
+    std::atomic<double>     m_publishedJitter{0};
+    std::atomic<double>     m_publishedMin{0};
+    std::atomic<double>     m_publishedMax{0};
+
+    std::atomic<quint64> m_bytesRead{0};        // 收到的字节数
+    std::atomic<quint64> m_samplesDecoded{0};   // 解码出的采样数
+    std::atomic<quint64> m_dropped{0};      // 缓冲区满时丢弃的采样数
+    std::atomic<quint64> m_recordDropped{0};    // 录制缓冲区满时未录制的采样数（曲线不受影响）
+    std::atomic<quint64> m_parseErrors{0};  // 解析失败的帧数
+    std::atomic<quint64> m_crcErrors{0};    // CRC校验失败的包数（二进制协议）
+    std::atomic<quint64> m_resyncs{0};      // 重新同步的次数（二进制协议）
+};
+
+#endif // SERIALREADER_H
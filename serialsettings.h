@@ -0,0 +1,50 @@
+#ifndef SERIALSETTINGS_H
+#define SERIALSETTINGS_H
+
+#include <QSerialPort>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief 串口与采集配置。
+ *
+ * 由SettingsDialog填写，也可由无界面程序从命令行参数填写，
+ * 采集代码只依赖本结构体，不依赖QtWidgets。
+ */
+struct SerialSettings
+{
+    enum WindowMode {
+        WindowAll,      // 显示全部历史数据
+        WindowSeconds,  // 只保留最近N秒
+        WindowSamples,  // 只保留最近N个点
+        WindowSweep     // 示波器扫描：时间轴固定为N秒，到右端后从左端重新覆盖
+    };
+
+    enum Protocol {
+        ProtocolText,   // 文本行，见SampleDecoder
+        ProtocolBinary  // 二进制数据包，见PacketDecoder
+    };
+
+    QString name;
+    QStringList portNames;  // 要同时打开的全部串口（第一个为name）
+    qint32 baudRate;
+    QString stringBaudRate;
+    QSerialPort::DataBits dataBits;
+    QString stringDataBits;
+    QSerialPort::Parity parity;
+    QString stringParity;
+    QSerialPort::StopBits stopBits;
+    QString stringStopBits;
+    QSerialPort::FlowControl flowControl;
+    QString stringFlowControl;
+    Protocol protocol;
+    QString stringProtocol;
+    bool localEchoEnabled;
+    bool deviceTimestamps;
+    WindowMode windowMode;
+    QString stringWindowMode;
+    double windowSize;
+    QString trigger;        // 触发条件，空为不触发，格式见TriggerConfig
+};
+
+#endif // SERIALSETTINGS_H
@@ -161,6 +161,14 @@ void SettingsDialog::fillPortsParameters()
     m_ui->flowControlBox->addItem(tr("None"), QSerialPort::NoFlowControl);
     m_ui->flowControlBox->addItem(tr("RTS/CTS"), QSerialPort::HardwareControl);
     m_ui->flowControlBox->addItem(tr("XON/XOFF"), QSerialPort::SoftwareControl);
+
+    m_ui->protocolBox->addItem(tr("Text"), SerialSettings::ProtocolText);
+    m_ui->protocolBox->addItem(tr("Binary (CRC16)"), SerialSettings::ProtocolBinary);
+
+    m_ui->windowModeBox->addItem(tr("All"), SerialSettings::WindowAll);
+    m_ui->windowModeBox->addItem(tr("Last seconds"), SerialSettings::WindowSeconds);
+    m_ui->windowModeBox->addItem(tr("Last samples"), SerialSettings::WindowSamples);
+    m_ui->windowModeBox->addItem(tr("Sweep seconds"), SerialSettings::WindowSweep);
 }
 
 void SettingsDialog::fillPortsInfo()
@@ -186,12 +194,30 @@ void SettingsDialog::fillPortsInfo()
         m_ui->serialPortInfoListBox->addItem(list.first(), list);
     }
 
+    // 虚拟串口：合成信号，参数可在Custom中手动填写，见VirtualDevice
+    m_ui->serialPortInfoListBox->addItem(QStringLiteral("sim"),
+                                         QStringList() << QStringLiteral("sim") << tr("Synthetic signal generator")
+                                                       << blankString << blankString << blankString
+                                                       << blankString << blankString);
+    m_ui->serialPortInfoListBox->addItem(QStringLiteral("sim:rate=100000;columns=4;malformed=0.001"),
+                                         QStringList() << QStringLiteral("sim") << tr("Synthetic load test, 100 kHz")
+                                                       << blankString << blankString << blankString
+                                                       << blankString << blankString);
+
     m_ui->serialPortInfoListBox->addItem(tr("Custom"));
 }
 
 void SettingsDialog::updateSettings()
 {
     m_currentSettings.name = m_ui->serialPortInfoListBox->currentText();
+    m_currentSettings.portNames = QStringList(m_currentSettings.name);
+    // 不用已过时的QString::SkipEmptyParts，空项在下面去掉首尾空白后跳过
+    const QStringList additionalPorts = m_ui->additionalPortsEdit->text().split(QLatin1Char(','));
+    for (const QString &port : additionalPorts) {
+        const QString name = port.trimmed();
+        if (!name.isEmpty() && !m_currentSettings.portNames.contains(name))
+            m_currentSettings.portNames.append(name);
+    }
 
     if (m_ui->baudRateBox->currentIndex() == 4) {
         m_currentSettings.baudRate = m_ui->baudRateBox->currentText().toInt();
@@ -217,5 +243,16 @@ void SettingsDialog::updateSettings()
                 m_ui->flowControlBox->itemData(m_ui->flowControlBox->currentIndex()).toInt());
     m_currentSettings.stringFlowControl = m_ui->flowControlBox->currentText();
 
+    m_currentSettings.protocol = static_cast<SerialSettings::Protocol>(
+                m_ui->protocolBox->itemData(m_ui->protocolBox->currentIndex()).toInt());
+    m_currentSettings.stringProtocol = m_ui->protocolBox->currentText();
+
     m_currentSettings.localEchoEnabled = m_ui->localEchoCheckBox->isChecked();
+    m_currentSettings.deviceTimestamps = m_ui->deviceTimestampCheckBox->isChecked();
+
+    m_currentSettings.windowMode = static_cast<SerialSettings::WindowMode>(
+                m_ui->windowModeBox->itemData(m_ui->windowModeBox->currentIndex()).toInt());
+    m_currentSettings.stringWindowMode = m_ui->windowModeBox->currentText();
+    m_currentSettings.windowSize = m_ui->windowSizeBox->value();
+    m_currentSettings.trigger = m_ui->triggerEdit->text().trimmed();
 }
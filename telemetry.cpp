@@ -0,0 +1,167 @@
+#include "telemetry.h"
+
+#include <QtMath>
+
+/**
+ * @brief 清零所有统计，开始新的统计周期。
+ */
+void Telemetry::reset()
+{
+    m_clock.start();
+    m_periodStart = 0;
+    m_lastFrameNs = -1;
+    m_lastBytes = 0;
+    m_lastSamples = 0;
+    m_peakFill = 0;
+    m_frames = 0;
+    m_replots = 0;
+    m_replotTotalMs = 0;
+    m_replotMaxMs = 0;
+    m_rasters = 0;
+    m_rasterTotalMs = 0;
+    m_rasterMaxMs = 0;
+    m_droppedFrames = 0;
+    m_snapshot = TelemetrySnapshot();
+}
+
+/**
+ * @brief 记录一次重绘定时器触发，两次触发间隔超过1.5个周期时计为错过的帧。
+ * @param intervalMs 重绘定时器周期（毫秒）。
+ */
+void Telemetry::frameStarted(int intervalMs)
+{
+    if (!m_clock.isValid())
+        reset();
+
+    const qint64 now = m_clock.nsecsElapsed();
+    if (m_lastFrameNs >= 0 && intervalMs > 0) {
+        const double gap = (now - m_lastFrameNs) * 1e-6 / intervalMs;
+        if (gap > 1.5)
+            m_droppedFrames += static_cast<quint64>(qRound(gap)) - 1;
+    }
+    m_lastFrameNs = now;
+}
+
+/**
+ * @brief 记录各串口缓冲区的占用率峰值。
+ */
+void Telemetry::observeBuffers(const ChannelManager &manager)
+{
+    for (int i = 0; i < manager.count(); ++i) {
+        const SpscRingBuffer<Sample> *buffer = manager.buffer(i);
+        const double fill = double(buffer->size()) / buffer->capacity();
+        if (fill > m_peakFill)
+            m_peakFill = fill;
+    }
+}
+
+void Telemetry::replotStarted()
+{
+    m_replotClock.start();
+}
+
+/**
+ * @brief 记录一次重绘的耗时；不在工作线程中绘制时这一帧已经完成，计入帧率。
+ */
+void Telemetry::replotFinished()
+{
+    if (!m_replotClock.isValid())
+        return;
+    const double ms = m_replotClock.nsecsElapsed() * 1e-6;
+    m_replotTotalMs += ms;
+    if (ms > m_replotMaxMs)
+        m_replotMaxMs = ms;
+    ++m_replots;
+    if (!m_threaded)
+        ++m_frames;
+}
+
+/**
+ * @brief 记录工作线程光栅化一帧的耗时，该帧计入帧率（被丢弃的帧不会走到这里）。
+ * @param ms 耗时（毫秒）。
+ */
+void Telemetry::rasterFinished(double ms)
+{
+    m_rasterTotalMs += ms;
+    if (ms > m_rasterMaxMs)
+        m_rasterMaxMs = ms;
+    ++m_rasters;
+    ++m_frames;
+}
+
+/**
+ * @brief 到达统计周期时读取各串口的计数器，计算速率并生成新快照。
+ * @return 生成了新快照时返回true。
+ */
+bool Telemetry::update(const ChannelManager &manager)
+{
+    if (!m_clock.isValid())
+        reset();
+
+    const double now = m_clock.nsecsElapsed() * 1e-9;
+    const double period = now - m_periodStart;
+    if (period < TELEMETRY_INTERVAL)
+        return false;
+
+    quint64 bytes = 0, samples = 0;
+    for (int i = 0; i < manager.count(); ++i) {
+        bytes += manager.reader(i)->bytesRead();
+        samples += manager.reader(i)->samplesDecoded();
+    }
+    // 重新打开串口后计数器从0开始
+    if (bytes < m_lastBytes || samples < m_lastSamples) {
+        m_lastBytes = 0;
+        m_lastSamples = 0;
+    }
+
+    m_snapshot.bytesPerSecond = (bytes - m_lastBytes) / period;
+    m_snapshot.samplesPerSecond = (samples - m_lastSamples) / period;
+    m_snapshot.parseErrors = manager.parseErrors();
+    m_snapshot.crcErrors = manager.crcErrors();
+    m_snapshot.droppedSamples = manager.droppedSamples();
+    m_snapshot.recordDroppedSamples = manager.recordDroppedSamples();
+    m_snapshot.bufferFill = m_peakFill;
+    m_snapshot.framesPerSecond = m_frames / period;
+    m_snapshot.replotMs = m_replots > 0 ? m_replotTotalMs / m_replots : 0;
+    m_snapshot.replotMaxMs = m_replotMaxMs;
+    m_snapshot.rasterMs = m_rasters > 0 ? m_rasterTotalMs / m_rasters : 0;
+    m_snapshot.rasterMaxMs = m_rasterMaxMs;
+    m_snapshot.droppedFrames = m_droppedFrames;
+
+    m_lastBytes = bytes;
+    m_lastSamples = samples;
+    m_periodStart = now;
+    m_peakFill = 0;
+    m_frames = 0;
+    m_replots = 0;
+    m_replotTotalMs = 0;
+    m_replotMaxMs = 0;
+    m_rasters = 0;
+    m_rasterTotalMs = 0;
+    m_rasterMaxMs = 0;
+    return true;
+}
+
+/**
+ * @brief 单行文本形式的指标，用于状态栏和绘图区叠加显示。
+ */
+QString Telemetry::toString() const
+{
+    const TelemetrySnapshot &s = m_snapshot;
+    QString text = QString("%1 kB/s  %2 samples/s  fill %3%  replot %4/%5 ms  ")
+            .arg(s.bytesPerSecond / 1000, 0, 'f', 1)
+            .arg(s.samplesPerSecond, 0, 'f', 0)
+            .arg(s.bufferFill * 100, 0, 'f', 0)
+            .arg(s.replotMs, 0, 'f', 1)
+            .arg(s.replotMaxMs, 0, 'f', 1);
+    if (s.rasterMaxMs > 0)  // 只在工作线程绘制时显示
+        text += QString("raster %1/%2 ms  ").arg(s.rasterMs, 0, 'f', 1).arg(s.rasterMaxMs, 0, 'f', 1);
+    text += QString("%1 fps  dropped %2 samples / %3 frames  errors %4")
+            .arg(s.framesPerSecond, 0, 'f', 0)
+            .arg(s.droppedSamples)
+            .arg(s.droppedFrames)
+            .arg(s.parseErrors + s.crcErrors);
+    if (s.recordDroppedSamples > 0)     // 只在录制丢数据时显示
+        text += QString("  not recorded %1 samples").arg(s.recordDroppedSamples);
+    return text;
+}
@@ -0,0 +1,76 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include "channelmanager.h"
+
+#define TELEMETRY_INTERVAL 1.0  // 统计周期（秒）
+
+/* 一个统计周期内的采集与绘制指标 */
+struct TelemetrySnapshot
+{
+    double  bytesPerSecond = 0;     // 串口输入字节率
+    double  samplesPerSecond = 0;   // 解码出的采样率
+    quint64 parseErrors = 0;        // 累计解析失败的帧数
+    quint64 crcErrors = 0;          // 累计CRC校验失败的包数
+    quint64 droppedSamples = 0;     // 累计因缓冲区满丢弃的采样数
+    quint64 recordDroppedSamples = 0;   // 累计因录制缓冲区满未录制的采样数
+    double  bufferFill = 0;         // 周期内各缓冲区的最高占用率（0~1）
+    double  framesPerSecond = 0;    // 实际重绘帧率（完成的重绘数，工作线程绘制时为光栅化完成的帧数）
+    double  replotMs = 0;           // 平均重绘耗时
+    double  replotMaxMs = 0;        // 最长重绘耗时
+    double  rasterMs = 0;           // 工作线程绘制时的平均光栅化耗时，未开启时为0
+    double  rasterMaxMs = 0;        // 工作线程绘制时的最长光栅化耗时
+    quint64 droppedFrames = 0;      // 累计错过的重绘帧数
+};
+
+/**
+ * @brief 采集与绘制流水线的运行指标。
+ *
+ * 读取线程的计数器均为原子变量，这里只在GUI线程中周期性读取并求差，
+ * 不加锁、不影响采集，可以长期开启。
+ * 在工作线程中绘制时，重绘耗时只包括在GUI线程中记录绘制命令的时间，光栅化耗时由工作线程另行报告。
+ */
+class Telemetry
+{
+public:
+    void reset();
+    void setThreadedRendering(bool enabled) { m_threaded = enabled; }  // 工作线程绘制时按光栅化完成的帧计算帧率
+
+    void frameStarted(int intervalMs);                  // 每次重绘定时器触发时调用，统计错过的帧（不计入帧率）
+    void observeBuffers(const ChannelManager &manager); // 取数据前调用，记录缓冲区占用峰值
+    void replotStarted();                               // QCustomPlot::beforeReplot
+    void replotFinished();                              // QCustomPlot::afterReplot
+    void rasterFinished(double ms);                     // QCustomPlot::afterRender（工作线程绘制）
+
+    bool update(const ChannelManager &manager);         // 到达统计周期时生成新快照并返回true
+    const TelemetrySnapshot &snapshot() const { return m_snapshot; }
+    QString toString() const;
+
+private:
+    QElapsedTimer       m_clock;
+    QElapsedTimer       m_replotClock;
+    double              m_periodStart = 0;
+    qint64              m_lastFrameNs = -1;
+    bool                m_threaded = false;
+
+    quint64             m_lastBytes = 0;
+    quint64             m_lastSamples = 0;
+
+    /* 当前周期的累计量 */
+    double              m_peakFill = 0;
+    int                 m_frames = 0;       // 完成的帧数
+    int                 m_replots = 0;
+    double              m_replotTotalMs = 0;
+    double              m_replotMaxMs = 0;
+    int                 m_rasters = 0;
+    double              m_rasterTotalMs = 0;
+    double              m_rasterMaxMs = 0;
+    quint64             m_droppedFrames = 0;
+
+    TelemetrySnapshot   m_snapshot;
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,272 @@
+#include "trigger.h"
+
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief 解析触发条件字符串。
+ * @param spec 触发条件，格式见TriggerConfig。
+ * @param config 解析结果，失败时不修改。
+ * @param errorString 失败时写入原因，可为nullptr。
+ * @return 解析成功返回true。
+ */
+bool TriggerConfig::parse(const QString &spec, TriggerConfig *config, QString *errorString)
+{
+    auto fail = [errorString](const QString &message) {
+        if (errorString)
+            *errorString = message;
+        return false;
+    };
+
+    TriggerConfig c;
+    const QString trimmed = spec.trimmed();
+    const int colon = trimmed.indexOf(QLatin1Char(':'));
+    const QString type = (colon >= 0 ? trimmed.left(colon) : trimmed).trimmed().toLower();
+    if (type.isEmpty() || type == QLatin1String("off")) {
+        *config = c;
+        return true;
+    }
+    if (type == QLatin1String("level"))
+        c.type = Level;
+    else if (type == QLatin1String("edge"))
+        c.type = Edge;
+    else if (type == QLatin1String("slope"))
+        c.type = Slope;
+    else if (type == QLatin1String("window"))
+        c.type = Window;
+    else
+        return fail(QObject::tr("Unknown trigger type \"%1\"").arg(type));
+
+    const QStringList items = colon >= 0 ? trimmed.mid(colon + 1).split(QLatin1Char(';')) : QStringList();
+    for (const QString &item : items) {
+        if (item.trimmed().isEmpty())
+            continue;
+        const int equals = item.indexOf(QLatin1Char('='));
+        const QString key = item.left(equals).trimmed().toLower();
+        const QString text = equals > 0 ? item.mid(equals + 1).trimmed() : QString();
+        bool ok = true;
+        const double value = text.toDouble(&ok);
+
+        if (key == QLatin1String("dir")) {
+            if (text == QLatin1String("rising"))
+                c.direction = Rising;
+            else if (text == QLatin1String("falling"))
+                c.direction = Falling;
+            else if (text == QLatin1String("either"))
+                c.direction = Either;
+            else
+                return fail(QObject::tr("Invalid trigger direction \"%1\"").arg(text));
+            continue;
+        }
+        if (!ok)
+            return fail(QObject::tr("Invalid trigger parameter \"%1\"").arg(item.trimmed()));
+        if ((key == QLatin1String("pre") || key == QLatin1String("post") || key == QLatin1String("span"))
+                && value > TRIGGER_MAX_SAMPLES)
+            return fail(QObject::tr("Trigger parameter \"%1\" exceeds %2 samples").arg(key).arg(TRIGGER_MAX_SAMPLES));
+        if (key == QLatin1String("level"))
+            c.level = value;
+        else if (key == QLatin1String("hyst"))
+            c.hysteresis = std::fabs(value);
+        else if (key == QLatin1String("slope"))
+            c.slope = std::fabs(value);
+        else if (key == QLatin1String("span") && value >= 1)
+            c.span = static_cast<std::size_t>(value);
+        else if (key == QLatin1String("low"))
+            c.low = value;
+        else if (key == QLatin1String("high"))
+            c.high = value;
+        else if (key == QLatin1String("inside"))
+            c.inside = value != 0;
+        else if (key == QLatin1String("pre") && value >= 0)
+            c.pre = static_cast<std::size_t>(value);
+        else if (key == QLatin1String("post") && value >= 0)
+            c.post = static_cast<std::size_t>(value);
+        else if (key == QLatin1String("single"))
+            c.single = value != 0;
+        else
+            return fail(QObject::tr("Invalid trigger parameter \"%1\"").arg(item.trimmed()));
+    }
+
+    if (c.type == Level && c.direction == Either)
+        return fail(QObject::tr("A level trigger needs dir=rising or dir=falling"));
+    if (c.type == Window && c.low >= c.high)
+        return fail(QObject::tr("A window trigger needs low < high"));
+
+    *config = c;
+    return true;
+}
+
+/**
+ * @brief 构造函数。
+ * @param config 触发条件。
+ */
+TriggerEngine::TriggerEngine(const TriggerConfig &config)
+{
+    setConfig(config);
+}
+
+/**
+ * @brief 设置触发条件，按新的点数预先分配触发前环形缓冲区并重新准备。
+ *
+ * 捕获缓冲区在首次触发时才分配，多串口多列时未触发的通道只占用触发前缓冲区。
+ * @param config 触发条件。
+ */
+void TriggerEngine::setConfig(const TriggerConfig &config)
+{
+    m_config = config;
+    const bool on = enabled();  // 未设置触发条件时不占用内存
+    m_pre.assign(on ? m_config.pre : 0, Sample());
+    m_capture.clear();
+    m_capture.shrink_to_fit();
+    m_slopeHistory.assign(on && m_config.type == TriggerConfig::Slope ? m_config.span : 0, Sample());
+    m_triggerTime = 0;
+    m_captureCount = 0;
+    rearm();
+}
+
+/**
+ * @brief 丢弃捕获数据和触发前历史，重新等待触发。
+ */
+void TriggerEngine::rearm()
+{
+    m_preNext = 0;
+    m_preFilled = 0;
+    m_slopeNext = 0;
+    m_slopeFilled = 0;
+    arm();
+}
+
+/**
+ * @brief 进入等待触发状态，保留触发前历史。
+ */
+void TriggerEngine::arm()
+{
+    m_capture.clear();
+    m_triggerIndex = 0;
+    m_remaining = 0;
+    m_side = 0;
+    m_primed = false;
+    m_state = enabled() ? Armed : Disarmed;
+}
+
+/**
+ * @brief 输入一个采样点。
+ * @param s 采样点（同一通道内按时间递增）。
+ * @return 本点完成一次捕获时返回true，捕获数据见capture()。
+ */
+bool TriggerEngine::addSample(const Sample &s)
+{
+    if (m_state == Captured) {
+        if (m_config.single)
+            return false;   // 保持冻结，直到rearm()
+        arm();              // 触发前历史在采集期间持续更新，可直接用于下一次触发
+    }
+    if (m_state == Disarmed)
+        return false;
+
+    bool completed = false;
+    if (m_state == Collecting) {
+        m_capture.push_back(s);
+        completed = --m_remaining == 0;
+    } else if (fires(s)) {
+        // 一次分配整个捕获的容量，arm()只清空不释放，之后的捕获不再分配
+        m_capture.reserve(m_pre.size() + 1 + m_config.post);
+        // 触发前的点按时间顺序放在前面，随后是触发点
+        const std::size_t pre = m_pre.size();
+        for (std::size_t i = m_preFilled; i > 0; --i)
+            m_capture.push_back(m_pre[(m_preNext + pre - i) % pre]);
+        m_triggerIndex = m_capture.size();
+        m_triggerTime = s.time;
+        m_capture.push_back(s);
+        m_remaining = m_config.post;
+        completed = m_remaining == 0;
+        if (!completed)
+            m_state = Collecting;
+    }
+    if (completed) {
+        m_state = Captured;
+        ++m_captureCount;
+    }
+
+    pushHistory(s);
+    return completed;
+}
+
+/**
+ * @brief 判定本点是否满足触发条件，同时更新边沿方向和条件是否曾不满足的状态。
+ * @param s 采样点。
+ */
+bool TriggerEngine::fires(const Sample &s)
+{
+    const TriggerConfig &c = m_config;
+    switch (c.type) {
+    case TriggerConfig::Level:
+        return c.direction == TriggerConfig::Falling ? s.value <= c.level : s.value >= c.level;
+
+    case TriggerConfig::Edge:
+    {
+        const bool rising = m_side < 0 && s.value >= c.level && c.direction != TriggerConfig::Falling;
+        const bool falling = m_side > 0 && s.value <= c.level && c.direction != TriggerConfig::Rising;
+        if (s.value < c.level - c.hysteresis)
+            m_side = -1;
+        else if (s.value > c.level + c.hysteresis)
+            m_side = 1;
+        return rising || falling;
+    }
+
+    case TriggerConfig::Slope:
+    {
+        if (m_slopeFilled < m_slopeHistory.size())
+            return false;
+        const Sample &old = m_slopeHistory[m_slopeNext];   // 环形缓冲区已满时，下一个写入位置即最早的点
+        const double dt = s.time - old.time;
+        if (dt <= 0)
+            return false;
+        const double slope = (s.value - old.value) / dt;
+        bool condition;
+        if (c.direction == TriggerConfig::Rising)
+            condition = slope >= c.slope;
+        else if (c.direction == TriggerConfig::Falling)
+            condition = slope <= -c.slope;
+        else
+            condition = std::fabs(slope) >= c.slope;
+        const bool primed = m_primed;
+        m_primed = !condition;
+        return condition && primed;
+    }
+
+    case TriggerConfig::Window:
+    {
+        const bool inWindow = s.value >= c.low && s.value <= c.high;
+        const bool condition = c.inside ? inWindow : !inWindow;
+        const bool primed = m_primed;
+        m_primed = !condition;
+        return condition && primed;
+    }
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief 把采样点记入触发前环形缓冲区和斜率历史。
+ * @param s 采样点。
+ */
+void TriggerEngine::pushHistory(const Sample &s)
+{
+    if (!m_pre.empty()) {
+        m_pre[m_preNext] = s;
+        m_preNext = (m_preNext + 1) % m_pre.size();
+        m_preFilled = std::min(m_preFilled + 1, m_pre.size());
+    }
+    if (m_config.type == TriggerConfig::Slope) {
+        m_slopeHistory[m_slopeNext] = s;
+        m_slopeNext = (m_slopeNext + 1) % m_slopeHistory.size();
+        m_slopeFilled = std::min(m_slopeFilled + 1, m_slopeHistory.size());
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <QString>
+
+#include <cstddef>
+#include <vector>
+
+#include "sample.h"
+
+#define TRIGGER_PRE_SAMPLES 500     // 默认触发前保留点数
+#define TRIGGER_POST_SAMPLES 2000   // 默认触发后采集点数
+#define TRIGGER_MAX_SAMPLES 1000000 // pre、post、span的上限，触发前缓冲区按pre预先分配，捕获缓冲区在触发时分配
+
+/**
+ * @brief 触发条件。
+ *
+ * 由字符串解析得到，格式与虚拟串口参数相同："类型[:参数=值;...]"，空字符串或"off"为不触发。
+ * 类型：
+ *   level   数值不低于（dir=falling时为不高于）level时触发，条件一直满足时每次重新准备后立即再次触发；
+ *   edge    数值穿越level时触发，须先到达另一侧超过回差hyst才能触发，避免噪声反复触发；
+ *   slope   最近span个点的平均斜率（每秒）达到slope时触发；
+ *   window  数值离开[low, high]时触发，inside=1时为进入时触发。
+ * edge、slope、window须先观察到条件不满足，再在条件满足时触发。
+ * 公共参数（括号内为默认值）：dir（rising）触发方向，rising/falling/either；
+ *   pre（500）触发前保留点数；post（2000）触发后采集点数；single（0）为1时只捕获一次。
+ * pre、post和span不能超过TRIGGER_MAX_SAMPLES。
+ * 例：edge:level=30;hyst=0.2;pre=1000;post=5000
+ */
+struct TriggerConfig
+{
+    enum Type { Off, Level, Edge, Slope, Window };
+    enum Direction { Rising, Falling, Either };
+
+    Type        type = Off;
+    Direction   direction = Rising;
+    double      level = 0;          // 电平（level、edge）
+    double      hysteresis = 0;     // 回差（edge）
+    double      slope = 0;          // 斜率阈值，每秒（slope）
+    std::size_t span = 1;           // 计算斜率跨越的点数（slope）
+    double      low = 0;            // 窗口下限（window）
+    double      high = 0;           // 窗口上限（window）
+    bool        inside = false;     // 进入窗口时触发（window）
+    std::size_t pre = TRIGGER_PRE_SAMPLES;
+    std::size_t post = TRIGGER_POST_SAMPLES;
+    bool        single = false;     // 只捕获一次，之后须调用TriggerEngine::rearm()
+
+    static bool parse(const QString &spec, TriggerConfig *config, QString *errorString = nullptr);
+};
+
+/**
+ * @brief 流式触发器：在解码后的数据流上判定触发条件，捕获触发点前后的一段数据。
+ *
+ * 每个采样点O(1)处理，不保存完整历史。最近pre个点保存在预先分配的环形缓冲区中，
+ * 触发后再采集post个点，与触发前的点合成一段按时间排列的捕获数据并冻结。
+ * 捕获数据在下一次addSample()之前有效；之后自动重新准备，single为1时保持冻结直到rearm()。
+ */
+class TriggerEngine
+{
+public:
+    enum State {
+        Disarmed,   // 未设置触发条件
+        Armed,      // 等待触发
+        Collecting, // 已触发，正在采集触发后的点
+        Captured    // 捕获完成，数据已冻结
+    };
+
+    explicit TriggerEngine(const TriggerConfig &config = TriggerConfig());
+
+    void setConfig(const TriggerConfig &config);    // 设置触发条件并重新准备
+    const TriggerConfig &config() const { return m_config; }
+    bool enabled() const { return m_config.type != TriggerConfig::Off; }
+    State state() const { return m_state; }
+
+    bool addSample(const Sample &s);    // 返回true表示本点完成了一次捕获
+    void rearm();                       // 丢弃捕获数据和触发前历史，重新准备
+
+    const std::vector<Sample> &capture() const { return m_capture; }    // 捕获数据（按时间排列）
+    std::size_t triggerIndex() const { return m_triggerIndex; }         // 触发点在capture()中的下标
+    double triggerTime() const { return m_triggerTime; }                // 最近一次触发的时间，尚未触发时为0
+    quint64 captureCount() const { return m_captureCount; }             // 已完成的捕获次数
+
+private:
+    void arm();
+    bool fires(const Sample &s);        // 判定触发条件并更新判定状态
+    void pushHistory(const Sample &s);  // 记入触发前环形缓冲区和斜率历史
+
+    TriggerConfig       m_config;
+    State               m_state;
+
+    std::vector<Sample> m_pre;          // 触发前环形缓冲区，容量pre
+    std::size_t         m_preNext;      // 下一个写入位置
+    std::size_t         m_preFilled;    // 已写入个数（不超过pre）
+
+    std::vector<Sample> m_capture;      // 捕获数据，首次触发时分配容量pre+1+post
+    std::size_t         m_triggerIndex;
+    std::size_t         m_remaining;    // 还需采集的触发后点数
+
+    std::vector<Sample> m_slopeHistory; // 最近span个点（环形），用于计算斜率
+    std::size_t         m_slopeNext;
+    std::size_t         m_slopeFilled;
+
+    int                 m_side;         // edge：数值最近位于电平的哪一侧，-1下方，1上方，0未知
+    bool                m_primed;       // slope、window：已观察到条件不满足
+    double              m_triggerTime;
+    quint64             m_captureCount;
+};
+
+#endif // TRIGGER_H
@@ -0,0 +1,470 @@
+#include "virtualdevice.h"
+
+#include <QFile>
+
+#include <cmath>
+#include <cstring>
+
+#include "packetdecoder.h"
+#include "sampledecoder.h"
+
+namespace {
+
+/* 把非负整数写入缓冲区 */
+char *formatInteger(char *out, qint64 v)
+{
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    while (n > 0)
+        *out++ = digits[--n];
+    return out;
+}
+
+/* 把定点数写入缓冲区，比QByteArray::number快且不分配内存，最多写入24个字符 */
+char *formatFixed(char *out, double value, int decimals)
+{
+    static const double scales[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+    if (std::isnan(value)) {    // 解码器不接受，作为错误帧丢弃
+        memcpy(out, "nan", 3);
+        return out + 3;
+    }
+    if (value < 0) {
+        *out++ = '-';
+        value = -value;
+    }
+    if (std::isinf(value)) {
+        memcpy(out, "inf", 3);
+        return out + 3;
+    }
+    if (value * scales[decimals] >= 9e18) {
+        // 超出qint64范围，改用科学计数法：16位有效数字的尾数加指数，与区域设置无关
+        const int exponent = static_cast<int>(std::floor(std::log10(value))) - 15;
+        out = formatInteger(out, static_cast<qint64>(value / std::pow(10.0, exponent) + 0.5));
+        *out++ = 'e';
+        if (exponent < 0)
+            *out++ = '-';
+        return formatInteger(out, qAbs(exponent));
+    }
+
+    const qint64 scaled = static_cast<qint64>(value * scales[decimals] + 0.5);
+    out = formatInteger(out, scaled / static_cast<qint64>(scales[decimals]));
+    qint64 fraction = scaled % static_cast<qint64>(scales[decimals]);
+    if (decimals > 0) {
+        *out++ = '.';
+        for (int i = decimals - 1; i >= 0; --i) {
+            out[i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        out += decimals;
+    }
+    return out;
+}
+
+} // namespace
+
+/**
+ * @brief 判断串口名是否为虚拟串口。
+ */
+bool VirtualDevice::isVirtualPort(const QString &name)
+{
+    return name == QLatin1String("sim") || name.startsWith(QLatin1String("sim:"))
+            || name.startsWith(QLatin1String("replay:"));
+}
+
+/**
+ * @brief 按串口名创建虚拟串口。
+ * @param p 串口配置，name中带虚拟串口参数。
+ * @param parent 父对象指针。
+ * @return 虚拟串口（未打开），name不是虚拟串口时返回nullptr。
+ */
+VirtualDevice *VirtualDevice::create(const SerialSettings &p, QObject *parent)
+{
+    if (!isVirtualPort(p.name))
+        return nullptr;
+
+    const int colon = p.name.indexOf(QLatin1Char(':'));
+    QHash<QString, QString> params;
+    if (colon >= 0) {
+        const QStringList items = p.name.mid(colon + 1).split(QLatin1Char(';'));
+        for (const QString &item : items) {
+            const int equals = item.indexOf(QLatin1Char('='));
+            if (equals > 0)     // 空项和不带"="的项忽略
+                params.insert(item.left(equals).trimmed().toLower(), item.mid(equals + 1).trimmed());
+        }
+    }
+
+    if (p.name.startsWith(QLatin1String("replay:")))
+        return new StreamReplayer(p, params, parent);
+    return new SignalGenerator(p, params, parent);
+}
+
+VirtualDevice::VirtualDevice(const SerialSettings &p, const QHash<QString, QString> &params, QObject *parent)
+    : QIODevice(parent), m_settings(p), m_params(params)
+{
+    m_burst = param(QStringLiteral("burst"), 0);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(VIRTUAL_TICK_INTERVAL);
+    connect(&m_timer, &QTimer::timeout, this, &VirtualDevice::tick);
+}
+
+VirtualDevice::~VirtualDevice()
+{
+    m_timer.stop();
+}
+
+/**
+ * @brief 打开设备并开始产生数据，须在使用者所在线程中调用。
+ */
+bool VirtualDevice::open(OpenMode mode)
+{
+    m_pending.clear();
+    m_ready.clear();
+    if (!start())
+        return false;
+    if (!QIODevice::open(mode | QIODevice::Unbuffered))
+        return false;
+
+    m_clock.start();
+    m_lastDelivery = 0;
+    m_timer.start();
+    return true;
+}
+
+void VirtualDevice::close()
+{
+    m_timer.stop();
+    QIODevice::close();
+}
+
+/**
+ * @brief 读取一个参数，不存在或非法时返回默认值。
+ */
+double VirtualDevice::param(const QString &key, double defaultValue) const
+{
+    bool ok = false;
+    const double value = m_params.value(key).toDouble(&ok);
+    return ok ? value : defaultValue;
+}
+
+/**
+ * @brief 产生数据，按成批交付的设置移入可读缓冲区并通知读取方。
+ */
+void VirtualDevice::tick()
+{
+    const double elapsed = m_clock.nsecsElapsed() * 1e-9;
+    generate(elapsed);
+
+    if (m_pending.isEmpty() || (m_burst > 0 && elapsed - m_lastDelivery < m_burst))
+        return;
+    m_lastDelivery = elapsed;
+    m_ready += m_pending;
+    m_pending.clear();
+    emit readyRead();
+}
+
+qint64 VirtualDevice::readData(char *data, qint64 maxSize)
+{
+    const qint64 n = qMin<qint64>(maxSize, m_ready.size());
+    memcpy(data, m_ready.constData(), static_cast<std::size_t>(n));
+    m_ready.remove(0, static_cast<int>(n));
+    return n;
+}
+
+qint64 VirtualDevice::writeData(const char *, qint64 maxSize)
+{
+    return maxSize;     // 写入的数据直接丢弃
+}
+
+/**
+ * @brief 按当前协议编码一帧并追加到m_pending。
+ * @param values 各列数值。
+ * @param count 列数。
+ * @param time 帧时间（秒），开启设备时间戳时写入文本帧。
+ */
+void VirtualDevice::appendFrame(const double *values, int count, double time)
+{
+    if (m_settings.protocol == SerialSettings::ProtocolBinary)
+    {
+        char packet[PACKET_MAX_SIZE];
+        const int columns = qMin(count, PACKET_MAX_PAYLOAD / 4);
+        packet[0] = static_cast<char>(PACKET_SYNC0);
+        packet[1] = static_cast<char>(PACKET_SYNC1);
+        packet[2] = static_cast<char>(4 * columns);
+        packet[3] = 0;
+        packet[4] = PacketDecoder::PayloadFloat32;
+        char *p = packet + PACKET_HEADER_SIZE;
+        for (int i = 0; i < columns; ++i) {
+            const float value = static_cast<float>(values[i]);
+            quint32 bits;
+            memcpy(&bits, &value, sizeof(bits));
+            for (int b = 0; b < 4; ++b)
+                *p++ = static_cast<char>((bits >> (8 * b)) & 0xFF);
+        }
+        const quint16 crc = PacketDecoder::crc16(reinterpret_cast<const std::uint8_t *>(packet) + 2,
+                                                 static_cast<std::size_t>(p - packet - 2));
+        *p++ = static_cast<char>(crc & 0xFF);
+        *p++ = static_cast<char>(crc >> 8);
+        m_pending.append(packet, static_cast<int>(p - packet));
+        return;
+    }
+
+    char line[32 * (VIRTUAL_MAX_COLUMNS + 1)];
+    char *p = line;
+    if (m_settings.deviceTimestamps) {
+        p = formatFixed(p, time, 6);
+        *p++ = ',';
+    }
+    const int columns = qMin(count, VIRTUAL_MAX_COLUMNS);
+    for (int i = 0; i < columns; ++i) {
+        if (i > 0)
+            *p++ = ',';
+        p = formatFixed(p, values[i], 3);
+    }
+    *p++ = '\n';
+    m_pending.append(line, static_cast<int>(p - line));
+}
+
+/**
+ * @brief 构造函数，从参数中读取信号形状。
+ */
+SignalGenerator::SignalGenerator(const SerialSettings &p, const QHash<QString, QString> &params, QObject *parent)
+    : VirtualDevice(p, params, parent)
+{
+    m_rate = qMax(1.0, param(QStringLiteral("rate"), 1000));
+    m_columns = qBound(1, static_cast<int>(param(QStringLiteral("columns"), 1)), VIRTUAL_MAX_COLUMNS);
+    m_base = param(QStringLiteral("base"), 25);
+    m_step = param(QStringLiteral("step"), 10);
+    m_tau = qMax(1e-6, param(QStringLiteral("tau"), 0.5));
+    m_stepAt = param(QStringLiteral("stepat"), 2);
+    m_period = param(QStringLiteral("period"), 0);
+    m_noise = param(QStringLiteral("noise"), 0.05);
+    m_drift = param(QStringLiteral("drift"), 0);
+    m_malformed = param(QStringLiteral("malformed"), 0);
+    m_random.seed(static_cast<std::mt19937::result_type>(param(QStringLiteral("seed"), 1)));
+}
+
+bool SignalGenerator::start()
+{
+    m_frames = 0;
+    return true;
+}
+
+/**
+ * @brief 理想信号：阶跃（可往复）的一阶响应加线性漂移，第c列整体偏移0.5*c。
+ * @param t 时间（秒）。
+ * @param column 列号。
+ */
+double SignalGenerator::valueAt(double t, int column) const
+{
+    double level = 0;
+    if (t >= m_stepAt) {
+        double since = t - m_stepAt;
+        bool high = true;
+        if (m_period > 0) {
+            const double half = m_period / 2;
+            const double cycles = std::floor(since / half);
+            high = static_cast<qint64>(cycles) % 2 == 0;
+            since -= cycles * half;
+            // 每半个周期从上一个稳态出发
+            const double response = 1.0 - std::exp(-since / m_tau);
+            level = high ? response : 1.0 - response;
+        } else {
+            level = 1.0 - std::exp(-since / m_tau);
+        }
+    }
+    return m_base + 0.5 * column + m_step * level + m_drift * t;
+}
+
+/**
+ * @brief 产生截至elapsed应到达的全部帧。
+ */
+void SignalGenerator::generate(double elapsed)
+{
+    const quint64 due = static_cast<quint64>(elapsed * m_rate);
+    double values[VIRTUAL_MAX_COLUMNS];
+    for (; m_frames < due; ++m_frames)
+    {
+        const double t = m_frames / m_rate;
+        for (int c = 0; c < m_columns; ++c)
+            values[c] = valueAt(t, c) + m_noise * m_gauss(m_random);
+
+        if (m_malformed > 0 && m_uniform(m_random) < m_malformed)
+            appendMalformed(values, m_columns, t);
+        else
+            appendFrame(values, m_columns, t);
+    }
+}
+
+/**
+ * @brief 产生一个损坏的帧：文本协议为非法字符、缺少换行或超长行，二进制协议为翻转一个字节。
+ */
+void SignalGenerator::appendMalformed(const double *values, int count, double time)
+{
+    const int offset = m_pending.size();
+    appendFrame(values, count, time);
+    const int length = m_pending.size() - offset;
+
+    if (m_settings.protocol == SerialSettings::ProtocolBinary) {
+        const int i = offset + static_cast<int>(m_uniform(m_random) * length) % length;
+        m_pending[i] = static_cast<char>(m_pending.at(i) ^ (1 + static_cast<int>(m_uniform(m_random) * 255)));
+        return;
+    }
+
+    switch (static_cast<int>(m_uniform(m_random) * 3))
+    {
+    case 0:     // 非法字符
+        m_pending[offset + static_cast<int>(m_uniform(m_random) * (length - 1))] = 'x';
+        break;
+    case 1:     // 缺少换行，与下一帧粘连
+        m_pending.chop(1);
+        break;
+    default:    // 超长行
+        m_pending.insert(offset, QByteArray(2 * DECODER_MAX_FRAME, '9'));
+        break;
+    }
+}
+
+/**
+ * @brief 构造函数。
+ */
+StreamReplayer::StreamReplayer(const SerialSettings &p, const QHash<QString, QString> &params, QObject *parent)
+    : VirtualDevice(p, params, parent)
+{
+    m_speed = qMax(1e-3, param(QStringLiteral("speed"), 1));
+    m_loop = param(QStringLiteral("loop"), 0) != 0;
+    m_port = static_cast<int>(param(QStringLiteral("port"), 0));
+}
+
+/**
+ * @brief 打开回放文件：.tsrec录制文件以内存映射方式打开，其他文件整体读入。
+ *
+ * 录制文件（带魔数或.tsrec后缀）打不开、没有选定串口的采样点，或循环播放但只有一个时刻的采样点时报错。
+ */
+bool StreamReplayer::start()
+{
+    const QString fileName = m_params.value(QStringLiteral("file"));
+    m_next = 0;
+    m_sent = 0;
+    m_timeOffset = 0;
+    m_bytes.clear();
+
+    QString error;
+    if (m_recording.open(fileName, &error)) {
+        const Sample *samples = m_recording.samples();
+        const qint64 count = m_recording.count();
+        qint64 first = 0;
+        while (first < count && samples[first].port != m_port)
+            ++first;
+        if (first >= count) {
+            m_recording.close();
+            setErrorString(tr("%1: no samples for port %2").arg(fileName).arg(m_port));
+            return false;
+        }
+        qint64 last = count - 1;
+        while (samples[last].port != m_port)
+            --last;
+        qint64 second = first + 1;     // 下一个时刻的采样点，用于估计采样周期
+        while (second <= last && (samples[second].port != m_port || samples[second].time == samples[first].time))
+            ++second;
+
+        m_first = samples[first].time;
+        const double duration = samples[last].time - m_first;
+        if (m_loop && !(duration > 0)) {
+            m_recording.close();
+            setErrorString(tr("%1: port %2 has no time span to loop over").arg(fileName).arg(m_port));
+            return false;
+        }
+        m_loopPeriod = duration + (second <= last ? samples[second].time - m_first : 0);
+        return true;
+    }
+    if (RecordingFile::isRecording(fileName) || fileName.endsWith(QLatin1String(".tsrec"), Qt::CaseInsensitive)) {
+        setErrorString(fileName + ": " + error);
+        return false;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setErrorString(fileName + ": " + file.errorString());
+        return false;
+    }
+    m_bytes = file.readAll();
+    return true;
+}
+
+void StreamReplayer::generate(double elapsed)
+{
+    if (m_recording.count() > 0)
+        generateSamples(elapsed);
+    else
+        generateBytes(elapsed);
+}
+
+/**
+ * @brief 回放录制文件中选定串口的采样点，同一时刻的各列合成一帧。
+ *
+ * 循环播放时每一遍的时间加上m_loopPeriod，帧时间保持递增。
+ */
+void StreamReplayer::generateSamples(double elapsed)
+{
+    const Sample *samples = m_recording.samples();
+    const qint64 count = m_recording.count();
+    const double now = m_first + elapsed * m_speed;
+
+    double values[VIRTUAL_MAX_COLUMNS];
+    for (;;)
+    {
+        while (m_next < count)
+        {
+            // 找到下一个属于选定串口的采样点
+            while (m_next < count && samples[m_next].port != m_port)
+                ++m_next;
+            if (m_next >= count || samples[m_next].time + m_timeOffset > now)
+                break;
+
+            const double time = samples[m_next].time;
+            int columns = 0;
+            int lastColumn = -1;
+            for (; m_next < count; ++m_next) {
+                const Sample &s = samples[m_next];
+                if (s.port != m_port)
+                    continue;
+                if (s.time != time || s.column <= lastColumn || columns == VIRTUAL_MAX_COLUMNS)
+                    break;
+                values[columns++] = s.value;
+                lastColumn = s.column;
+            }
+            appendFrame(values, columns, time + m_timeOffset);
+        }
+
+        if (m_next < count || !m_loop)
+            break;
+        // start()已保证m_loopPeriod大于0，每一遍都向前推进
+        m_next = 0;
+        m_timeOffset += m_loopPeriod;
+    }
+}
+
+/**
+ * @brief 按波特率回放原始字节流（每字节10位）。
+ */
+void StreamReplayer::generateBytes(double elapsed)
+{
+    if (m_bytes.isEmpty())
+        return;
+
+    const double bytesPerSecond = qMax(1, m_settings.baudRate) / 10.0 * m_speed;
+    qint64 due = static_cast<qint64>(elapsed * bytesPerSecond);
+    while (due > m_sent)
+    {
+        const qint64 position = m_sent % m_bytes.size();
+        if (!m_loop && m_sent >= m_bytes.size())
+            return;
+        const qint64 n = qMin(due - m_sent, m_bytes.size() - position);
+        m_pending.append(m_bytes.constData() + position, static_cast<int>(n));
+        m_sent += n;
+    }
+}
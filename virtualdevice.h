@@ -0,0 +1,140 @@
+#ifndef VIRTUALDEVICE_H
+#define VIRTUALDEVICE_H
+
+#include <QIODevice>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QHash>
+
+#include <random>
+
+#include "serialsettings.h"
+#include "recording.h"
+
+#define VIRTUAL_TICK_INTERVAL 1     // 产生数据的周期（毫秒）
+#define VIRTUAL_MAX_COLUMNS 16      // 合成信号最多列数
+
+/**
+ * @brief 虚拟串口，代替QSerialPort向SerialReader提供字节流，用于无硬件测试和压力测试。
+ *
+ * 串口名以"sim"或"replay:"开头时使用虚拟串口，参数写在名称中，以';'分隔：
+ *   sim:rate=200000;columns=4;noise=0.1;malformed=0.001
+ *   replay:file=capture.tsrec;speed=10
+ * 输出格式与SettingsDialog中选择的协议一致（文本行或二进制数据包）。
+ * 在读取线程中打开，定时产生数据并发出readyRead()。
+ */
+class VirtualDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    ~VirtualDevice();
+
+    /* name为虚拟串口名时创建对应设备（未打开），否则返回nullptr */
+    static VirtualDevice *create(const SerialSettings &p, QObject *parent = nullptr);
+    static bool isVirtualPort(const QString &name);
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override { return m_ready.size() + QIODevice::bytesAvailable(); }
+
+protected:
+    VirtualDevice(const SerialSettings &p, const QHash<QString, QString> &params, QObject *parent);
+
+    virtual bool start() = 0;       // 打开时调用，失败时设置错误信息并返回false
+    virtual void generate(double elapsed) = 0;  // 产生截至elapsed（秒）应到达的数据，追加到m_pending
+
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+    double param(const QString &key, double defaultValue) const;
+
+    /* 按当前协议编码一帧：文本为"[时间,]数值1,数值2\n"，二进制为float32数据包 */
+    void appendFrame(const double *values, int count, double time);
+
+    SerialSettings              m_settings;
+    QHash<QString, QString>     m_params;
+    QByteArray                  m_pending;      // 本周期产生的数据（成批交付时累积）
+    double                      m_burst;        // 成批交付的间隔（秒），0为每个周期都交付
+
+private:
+    void tick();
+
+    QTimer                      m_timer;
+    QElapsedTimer               m_clock;
+    double                      m_lastDelivery = 0; // 上次交付的时刻（秒）
+    QByteArray                  m_ready;            // 已交付、可读取的数据
+};
+
+/**
+ * @brief 合成信号发生器：一阶阶跃响应 + 漂移 + 高斯噪声，可插入成批到达和错误帧。
+ *
+ * 参数（括号内为默认值）：
+ *   rate（1000）每秒帧数；columns（1）每帧列数；base（25）初值；step（10）阶跃幅度；
+ *   tau（0.5）时间常数（秒）；stepat（2）阶跃时刻（秒）；period（0）阶跃往复周期（秒，0为只阶跃一次）；
+ *   noise（0.05）噪声标准差；drift（0）每秒漂移；burst（0）成批交付间隔（秒）；
+ *   malformed（0）每帧损坏的概率；seed（1）随机数种子。
+ */
+class SignalGenerator : public VirtualDevice
+{
+    Q_OBJECT
+
+public:
+    SignalGenerator(const SerialSettings &p, const QHash<QString, QString> &params, QObject *parent = nullptr);
+
+    double valueAt(double t, int column) const;    // 不含噪声的理想信号
+
+protected:
+    bool start() override;
+    void generate(double elapsed) override;
+
+private:
+    void appendMalformed(const double *values, int count, double time);
+
+    double  m_rate, m_base, m_step, m_tau, m_stepAt, m_period, m_noise, m_drift, m_malformed;
+    int     m_columns;
+    quint64 m_frames = 0;   // 已产生的帧数
+
+    std::mt19937                        m_random;
+    std::normal_distribution<double>    m_gauss{0.0, 1.0};
+    std::uniform_real_distribution<double> m_uniform{0.0, 1.0};
+};
+
+/**
+ * @brief 录制回放：按原始时间（或加速）重新产生字节流。
+ *
+ * 参数：file 文件名；speed（1）回放速度倍数；port（0）.tsrec文件中回放的串口序号；loop（0）循环播放。
+ * .tsrec录制文件按采样点时间重新编码为帧，开启设备时间戳时帧中带原始时间（循环播放时逐遍递增）；
+ * 其他文件视为原始字节流，按波特率（每字节10位）的速度回放。
+ */
+class StreamReplayer : public VirtualDevice
+{
+    Q_OBJECT
+
+public:
+    StreamReplayer(const SerialSettings &p, const QHash<QString, QString> &params, QObject *parent = nullptr);
+
+protected:
+    bool start() override;
+    void generate(double elapsed) override;
+
+private:
+    void generateSamples(double elapsed);
+    void generateBytes(double elapsed);
+
+    double          m_speed;
+    bool            m_loop;
+    int             m_port;
+
+    RecordingFile   m_recording;    // .tsrec文件（内存映射）
+    qint64          m_next = 0;     // 下一个采样点下标
+    double          m_first = 0;    // 选定串口第一个采样点的时间
+    double          m_loopPeriod = 0;   // 循环播放一遍的时长：首末采样点间隔加一个采样周期
+    double          m_timeOffset = 0;   // 循环播放时累加的时间偏移
+
+    QByteArray      m_bytes;        // 原始字节流文件
+    qint64          m_sent = 0;     // 已产生的字节数
+};
+
+#endif // VIRTUALDEVICE_H